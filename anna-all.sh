@@ -2,12 +2,7 @@
 
 start_time=`date +%H:%M:%S`
 
-for g in usa zacks mdy biotech 3x canada
-do
-    echo "group=$g"
-    anna -group=$g $1
-    echo ""
-done
+anna -group=all $1
 
 end_time=`date +%H:%M:%S`
 
@@ -0,0 +1,250 @@
+/*
+ * rows/second of the vendor history tokenizer (csv_next_xxx) over the given
+ * csv files, read into memory as stock_price_from_file() does, next to the
+ * fgets()/strtok() and parse_price() path it replaced, on the same bytes.
+ * the checksums of both are the same if they parse the same. build with
+ * 'make bench'.
+ *
+ * usage: bench/csv_bench [-n=rounds] file.csv ...
+ */
+#include "csv.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct input
+{
+	const char *fname;
+	char *buf;
+	size_t len;
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int load_input(const char *fname, struct input *in)
+{
+	struct stat st;
+	int fd;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+
+	in->fname = fname;
+	in->len = st.st_size;
+	in->buf = calloc(1, in->len + 1);
+
+	if (!in->buf || read_full(fd, in->buf, in->len) < 0) {
+		anna_error("read(%s) failed\n", fname);
+		close(fd);
+		return -1;
+	}
+
+	close(fd);
+
+	return 0;
+}
+
+static int parse_by_line(const struct input *in, uint32_t *checksum)
+{
+	const char *line = strchr(in->buf, '\n');
+	int line_nr = 1, row_nr = 0;
+
+	while (line && *++line) {
+		struct csv_row row;
+		uint32_t open, high, low, close, volume, adj_close;
+		int year, month, mday;
+
+		line_nr += 1;
+
+		csv_row_init(&row, in->fname, line_nr, line);
+
+		if (csv_next_date(&row, &year, &month, &mday) == 0
+		    && csv_next_price(&row, &open) == 0
+		    && csv_next_price(&row, &high) == 0
+		    && csv_next_price(&row, &low) == 0
+		    && csv_next_price(&row, &close) == 0
+		    && csv_next_uint(&row, &volume) == 0
+		    && csv_next_price(&row, &adj_close) == 0)
+		{
+			*checksum += year * 10000 + month * 100 + mday + open + high + low + close + volume + adj_close;
+			row_nr += 1;
+		}
+
+		line = strchr(line, '\n');
+	}
+
+	return row_nr;
+}
+
+/* the price parser before the tokenizer, as it was */
+static void parse_price(char *price_str, uint32_t *price)
+{
+	char *dot = strchr(price_str, '.');
+
+	if (!dot) {
+		*price = atoi(price_str) * 1000;
+	}
+	else {
+		int i;
+		char saved_char = *dot;
+		*dot = 0;
+
+		*price = atoi(price_str) * 1000;
+
+		*dot = saved_char;
+
+		for (i = 1; *(dot + i) && isdigit(*(dot + i)) && i <= 3; i++)
+			*price += (*(dot + i) - '0') * (i == 1 ? 100 : ((i == 2) ? 10 : 1));
+
+		if (i == 4 && *(dot + i) && isdigit(*(dot + i)) && *(dot + i) >= '5')
+			*price += 1;
+	}
+}
+
+/* str2date() before the tokenizer, of a yahoo "yyyy-mm-dd" date */
+static int str2date(const char *date, int *year, int *month, int *mday)
+{
+	char _date[32];
+	char *token, *saved;
+
+	strlcpy(_date, date, sizeof(_date));
+
+	token = strtok_r(_date, "-", &saved);
+	if (!token) return -1;
+	*year = atoi(token);
+
+	token = strtok_r(NULL, "-", &saved);
+	if (!token) return -1;
+	*month = atoi(token);
+
+	token = strtok_r(NULL, "-", &saved);
+	if (!token) return -1;
+	*mday = atoi(token);
+
+	return 0;
+}
+
+/* the rows of stock_price_from_file() before the tokenizer: fgets() a line, strtok() its fields */
+static int parse_by_fgets(const struct input *in, uint32_t *checksum)
+{
+	char buf[1024];
+	int row_nr = 0;
+	FILE *fp;
+
+	fp = fmemopen(in->buf, in->len, "r");
+	if (!fp)
+		return 0;
+
+	/* skip the 1st line */
+	if (!fgets(buf, sizeof(buf), fp)) {
+		fclose(fp);
+		return 0;
+	}
+
+	while (fgets(buf, sizeof(buf), fp)) {
+		uint32_t open, high, low, close, volume, adj_close;
+		int year, month, mday;
+		char *token;
+
+		token = strtok(buf, ",");
+		if (!token || str2date(token, &year, &month, &mday) < 0) continue;
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		parse_price(token, &open);
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		parse_price(token, &high);
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		parse_price(token, &low);
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		parse_price(token, &close);
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		volume = atoi(token);
+
+		token = strtok(NULL, ",");
+		if (!token) continue;
+		parse_price(token, &adj_close);
+
+		*checksum += year * 10000 + month * 100 + mday + open + high + low + close + volume + adj_close;
+		row_nr += 1;
+	}
+
+	fclose(fp);
+
+	return row_nr;
+}
+
+static void run(const char *name, int (*parse)(const struct input *, uint32_t *),
+		const struct input *inputs, int input_nr, int rounds)
+{
+	uint32_t checksum = 0;
+	long row_nr = 0;
+	double start;
+	int r, i;
+
+	start = now();
+
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < input_nr; i++)
+			row_nr += parse(&inputs[i], &checksum);
+	}
+
+	printf("%-8s: %10.0f rows/s, %ld rows, checksum=%08x\n", name, row_nr / (now() - start), row_nr, checksum);
+}
+
+int main(int argc, char **argv)
+{
+	struct input *inputs;
+	int input_nr = 0;
+	int rounds = 100;
+	int i;
+
+	inputs = calloc(argc, sizeof(*inputs));
+	if (!inputs)
+		return 1;
+
+	for (i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "-n=", 3) == 0)
+			rounds = atoi(argv[i] + 3);
+		else if (load_input(argv[i], &inputs[input_nr]) == 0)
+			input_nr += 1;
+	}
+
+	if (!input_nr) {
+		printf("usage: %s [-n=rounds] file.csv ...\n", argv[0]);
+		return 1;
+	}
+
+	run("fgets", parse_by_fgets, inputs, input_nr, rounds);
+	run("line", parse_by_line, inputs, input_nr, rounds);
+
+	return 0;
+}
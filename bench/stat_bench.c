@@ -0,0 +1,168 @@
+/*
+ * rows/second of the statistics (indicators, candle stats, support and
+ * resistance) over synthetic daily histories of the given lengths in
+ * years, a random walk the same for every run. the checksum is over the
+ * computed columns, it doesn't change with the way they are computed.
+ * with -symbols=N, a group of N such histories is computed, each its own
+ * walk. build with 'make bench'.
+ *
+ * usage: bench/stat_bench [-n=rounds] [-symbols=N] [years ...]
+ */
+#include "stock_price.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BARS_PER_YEAR	252
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rand_next(uint64_t *seed)
+{
+	*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+	return *seed >> 33;
+}
+
+/* row_nr bars, latest first, around 50.000, the walk of symbol */
+static int synth_history(int row_nr, int symbol, struct stock_price *bars)
+{
+	uint64_t seed = 20170309 + symbol;
+	uint32_t close = 50000;
+	int i;
+
+	memset(bars, 0, sizeof(*bars));
+
+	if (stock_price_reserve(bars, row_nr) < 0)
+		return -1;
+
+	memset(bars->cold, 0, sizeof(*bars->cold) * row_nr);
+
+	for (i = row_nr - 1; i >= 0; i--) {
+		struct date_price *p = &bars->dateprice[i];
+		uint32_t range = close / 50 + 1;
+
+		memset(p, 0, sizeof(*p));
+
+		/* not calendar dates, only increasing */
+		p->date = 19000101 + (row_nr - 1 - i);
+		p->open = close - range / 2 + rand_next(&seed) % range;
+		close = close - range / 2 + rand_next(&seed) % range;
+		if (close < 1000)
+			close = 1000;
+		p->close = close;
+		p->high = (p->open > p->close ? p->open : p->close) + rand_next(&seed) % (range / 2 + 1);
+		p->low = (p->open < p->close ? p->open : p->close) - rand_next(&seed) % (range / 2 + 1);
+		p->volume = 100000 + rand_next(&seed) % 900000;
+	}
+
+	bars->date_cnt = row_nr;
+
+	return 0;
+}
+
+static uint32_t checksum_of(const struct stock_price *price)
+{
+	uint32_t sum = 0;
+	int i, k;
+
+	for (i = 0; i < price->date_cnt; i++) {
+		const struct date_price *p = &price->dateprice[i];
+
+		for (k = 0; k < SMA_NR; k++)
+			sum = sum * 31 + p->sma[k];
+		for (k = 0; k < VMA_NR; k++)
+			sum = sum * 31 + p->vma[k];
+		sum = sum * 31 + p->mfi;
+		sum = sum * 31 + (p->candle_color << 24 | p->candle_trend << 16 | p->sr_flag);
+		sum = sum * 31 + price->cold[i].height_low_spt + price->cold[i].height_high_rst;
+	}
+
+	return sum;
+}
+
+static void run(int years, int rounds, int symbol_nr)
+{
+	struct stock_price *bars, price = { };
+	uint32_t checksum = 0;
+	double start, elapsed;
+	long row_nr = 0;
+	int r, i;
+
+	bars = calloc(symbol_nr, sizeof(*bars));
+	if (!bars)
+		return;
+
+	for (i = 0; i < symbol_nr; i++) {
+		if (synth_history(years * BARS_PER_YEAR, i, &bars[i]) < 0)
+			goto finish;
+		row_nr += bars[i].date_cnt;
+	}
+
+	start = now();
+
+	/* appended to an empty history, all rows get their statistics at once */
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < symbol_nr; i++) {
+			price.date_cnt = 0;
+			stock_price_append(&price, &bars[i]);
+			if (r == rounds - 1)
+				checksum = checksum * 31 + checksum_of(&price);
+		}
+	}
+
+	elapsed = now() - start;
+
+	if (symbol_nr == 1)
+		printf("%3d years: %6d rows, %10.0f rows/s, %8.1f us/history, checksum=%08x\n",
+		       years, bars[0].date_cnt, (double)row_nr * rounds / elapsed, elapsed * 1e6 / rounds, checksum);
+	else
+		printf("%3d years x %d symbols: %8ld rows, %10.0f rows/s, %8.1f ms/group, checksum=%08x\n",
+		       years, symbol_nr, row_nr, (double)row_nr * rounds / elapsed, elapsed * 1e3 / rounds, checksum);
+
+finish:
+	stock_price_free(&price);
+	for (i = 0; i < symbol_nr; i++)
+		stock_price_free(&bars[i]);
+	free(bars);
+}
+
+int main(int argc, char **argv)
+{
+	static const int default_years[] = { 10, 25, 50, 100 };
+	int rounds = 20;
+	int symbol_nr = 1;
+	int i, year_nr = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "-n=", 3) == 0)
+			rounds = atoi(argv[i] + 3);
+		else if (strncmp(argv[i], "-symbols=", 9) == 0 && atoi(argv[i] + 9) > 0)
+			symbol_nr = atoi(argv[i] + 9);
+		else if (atoi(argv[i]) > 0) {
+			run(atoi(argv[i]), rounds, symbol_nr);
+			year_nr += 1;
+		}
+		else {
+			printf("usage: %s [-n=rounds] [-symbols=N] [years ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (!year_nr) {
+		for (i = 0; i < sizeof(default_years) / sizeof(default_years[0]); i++)
+			run(default_years[i], rounds, symbol_nr);
+	}
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include "csv.h"
+
+#include <string.h>
+
+#define is_digit(c)	((unsigned char)((c) - '0') <= 9)
+
+/* a field ends at ',', a line at '\n', '\r' or NUL */
+#define is_eol(c)	((c) == '\n' || (c) == '\r' || (c) == 0)
+
+void csv_row_init(struct csv_row *row, const char *fname, int line_nr, const char *line)
+{
+	row->fname = fname;
+	row->line_nr = line_nr;
+	row->cur = line;
+}
+
+/* p is where parsing of the current field stopped, which must be its end */
+static int csv_end_field(struct csv_row *row, const char *p)
+{
+	if (*p == ',') {
+		row->cur = p + 1;
+		return 0;
+	}
+
+	if (is_eol(*p)) {
+		row->cur = NULL;
+		return 0;
+	}
+
+	return -1;
+}
+
+int csv_next_field(struct csv_row *row, const char **field, int *len)
+{
+	const char *p = row->cur;
+
+	if (!p)
+		return -1;
+
+	while (*p != ',' && !is_eol(*p))
+		p++;
+
+	*field = row->cur;
+	*len = p - row->cur;
+
+	return csv_end_field(row, p);
+}
+
+int csv_next_uint(struct csv_row *row, uint32_t *val)
+{
+	const char *p = row->cur;
+	uint32_t v = 0;
+
+	if (!p || !is_digit(*p))
+		return -1;
+
+	while (is_digit(*p))
+		v = v * 10 + (*p++ - '0');
+
+	*val = v;
+
+	return csv_end_field(row, p);
+}
+
+/* "123.4567" to milli-units, rounded on the 4th decimal: 123457 */
+int csv_next_price(struct csv_row *row, uint32_t *price)
+{
+	static const uint32_t scale[3] = { 100, 10, 1 };
+	const char *p = row->cur;
+	uint32_t v = 0;
+	int i;
+
+	if (!p || !is_digit(*p))
+		return -1;
+
+	while (is_digit(*p))
+		v = v * 10 + (*p++ - '0');
+
+	v *= 1000;
+
+	if (*p == '.') {
+		p++;
+
+		for (i = 0; i < 3 && is_digit(*p); i++)
+			v += (*p++ - '0') * scale[i];
+
+		if (i == 3 && is_digit(*p) && *p >= '5')
+			v += 1;
+
+		while (is_digit(*p))
+			p++;
+	}
+
+	*price = v;
+
+	return csv_end_field(row, p);
+}
+
+static int month_from_str(const char *str)
+{
+	static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	int i;
+
+	for (i = 0; i < 12; i++) {
+		if (strncmp(str, &months[i * 3], 3) == 0)
+			return i + 1;
+	}
+
+	return 0;
+}
+
+static const char *parse_uint(const char *p, int *val)
+{
+	int v = 0;
+
+	if (!is_digit(*p))
+		return NULL;
+
+	while (is_digit(*p))
+		v = v * 10 + (*p++ - '0');
+
+	*val = v;
+
+	return p;
+}
+
+/* "yyyy-mm-dd" (yahoo, stored prices) or "d-Mon-yy" (google) */
+int csv_next_date(struct csv_row *row, int *year, int *month, int *mday)
+{
+	const char *p = row->cur;
+	int first;
+
+	if (!p || !(p = parse_uint(p, &first)) || *p++ != '-')
+		return -1;
+
+	if (is_digit(*p)) {
+		*year = first;
+
+		if (!(p = parse_uint(p, month)) || *p++ != '-' || !(p = parse_uint(p, mday)))
+			return -1;
+	}
+	else {
+		*mday = first;
+
+		*month = month_from_str(p);
+		if (!*month)
+			return -1;
+		p += 3;
+
+		if (*p++ != '-' || !(p = parse_uint(p, year)))
+			return -1;
+		*year += 2000;
+	}
+
+	if (*month < 1 || *month > 12 || *mday < 1 || *mday > 31)
+		return -1;
+
+	return csv_end_field(row, p);
+}
@@ -0,0 +1,28 @@
+#ifndef __CSV_H__
+#define __CSV_H__
+
+#include <stdint.h>
+
+/*
+ * single-pass tokenizer for one line of comma separated fields, the line is
+ * neither copied nor modified. every csv_next_xxx() consumes one field and
+ * returns -1 if it is missing or malformed; the row should then be dropped
+ * and reported with csv_error(), which prefixes fname:line_nr.
+ */
+struct csv_row
+{
+	const char *fname;
+	int line_nr;
+	const char *cur; /* start of the next field, NULL past the last one */
+};
+
+#define csv_error(row, fmt, args...) \
+	anna_error("%s:%d: " fmt, (row)->fname, (row)->line_nr, ##args)
+
+void csv_row_init(struct csv_row *row, const char *fname, int line_nr, const char *line);
+int csv_next_field(struct csv_row *row, const char **field, int *len);
+int csv_next_uint(struct csv_row *row, uint32_t *val);
+int csv_next_price(struct csv_row *row, uint32_t *price);
+int csv_next_date(struct csv_row *row, int *year, int *month, int *mday);
+
+#endif /* __CSV_H__ */
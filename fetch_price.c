@@ -101,15 +101,11 @@ static int do_fetch_price(char *output_fname, const char *symbol, int today_only
 	return 0;
 }
 
-static int stock_history_max_years(void)
-{
-	return 1;
-}
-
-static int fetch_realtime_price(const char *symbol)
+static int fetch_realtime_price(const struct price_store *store, const char *symbol)
 {
 	char output_fname[128];
 	struct date_price price = { };
+	struct stock_price history = { };
 	FILE *fp;
 
 	snprintf(output_fname, sizeof(output_fname), ROOT_DIR "/tmp/%s_today.price", symbol);
@@ -127,32 +123,38 @@ static int fetch_realtime_price(const char *symbol)
 	struct tm *now_tm = localtime(&now_t);
 	int year = 1900 + now_tm->tm_year;
 
-	snprintf(price.date, sizeof(price.date), "%d-%02d-%02d", year, now_tm->tm_mon + 1, now_tm->tm_mday);
+	price.date = year * 10000 + (now_tm->tm_mon + 1) * 100 + now_tm->tm_mday;
+
+	/* its averages carry on from the stored state of the latest bar */
+	if (stock_price_stored(store, symbol) && stock_price_open(store, symbol, &history) == 0
+	    && history.date_cnt && history.dateprice[0].date < price.date)
+		stock_price_next_bar(&history, &price);
+
+	stock_price_free(&history);
 
 	fp = fopen(output_fname, "w");
 	if (!fp) {
 		unlink(output_fname);
 	}
 	else {
-		fprintf_date_price(fp, &price);
+		fprintf_date_price(fp, &price, NULL);
 		fclose(fp);
 	}
 
 	return 0;
 }
 
-static int fetch_symbol_price_since_date(const char *group, const char *sector, const char *symbol, int year, int month, int mday)
+static int fetch_symbol_price_since_date(const struct price_store *store, const char *sector, const char *symbol, int year, int month, int mday)
 {
 	char output_fname[128];
 	struct stock_price price = { };
 	int rt = -1;
 
 	if (!year) {
-		return fetch_realtime_price(symbol);
+		return fetch_realtime_price(store, symbol);
 	}
 
-	snprintf(output_fname, sizeof(output_fname), ROOT_DIR "/%s/%s.price", group, symbol);
-	if (access(output_fname, F_OK) == 0) {
+	if (stock_price_stored(store, symbol)) {
 		//anna_info("%s already fetched, skip\n", symbol);
 		return -1;
 	}
@@ -169,8 +171,8 @@ static int fetch_symbol_price_since_date(const char *group, const char *sector,
 		goto finish;
 	}
 
-	if (stock_price_to_file(group, sector, symbol, &price) < 0) {
-		anna_error("stock_price_to_file('%s') failed\n", group);
+	if (stock_price_to_file(store, sector, symbol, &price) < 0) {
+		anna_error("stock_price_to_file('%s') failed\n", store->group);
 		goto finish;
 	}
 
@@ -178,29 +180,93 @@ static int fetch_symbol_price_since_date(const char *group, const char *sector,
 
 finish:
 	unlink(output_fname);
+	stock_price_free(&price);
 
 	return rt;
 }
 
-int fetch_symbols_price(int realtime, const char *group, const char *fname, int symbols_nr, const char **symbols)
+/* fetch the bars after symbol's latest stored date and append them */
+static int update_symbol_price(const struct price_store *store, const char *sector, const char *symbol, int year, int month, int mday)
+{
+	char output_fname[128] = { };
+	struct stock_price price = { };
+	struct stock_price bars = { };
+	struct tm since_tm = { };
+	int row_nr;
+	int rt = -1;
+
+	if (!stock_price_stored(store, symbol))
+		return fetch_symbol_price_since_date(store, sector, symbol, year, month, mday);
+
+	if (stock_price_load(store, symbol, &price) < 0 || price.date_cnt == 0) {
+		anna_error("%s: stock_price_load('%s') failed\n", symbol, store->group);
+		goto finish;
+	}
+
+	/* the day after the latest bar */
+	since_tm.tm_year = price.dateprice[0].date / 10000 - 1900;
+	since_tm.tm_mon = price.dateprice[0].date / 100 % 100 - 1;
+	since_tm.tm_mday = price.dateprice[0].date % 100 + 1;
+	since_tm.tm_hour = 12;
+	mktime(&since_tm);
+
+	snprintf(output_fname, sizeof(output_fname), ROOT_DIR_TMP "/%s.price", symbol);
+
+	if (do_fetch_price(output_fname, symbol, 0, 1900 + since_tm.tm_year, since_tm.tm_mon, since_tm.tm_mday) < 0)
+		goto finish;
+
+	if (stock_price_from_file(output_fname, &bars) < 0) {
+		anna_error("stock_price_from_file(%s) failed\n", output_fname);
+		goto finish;
+	}
+
+	row_nr = stock_price_append(&price, &bars);
+	if (row_nr < 0)
+		goto finish;
+
+	if (row_nr && stock_price_rows_to_file(store, sector ? sector : price.sector, symbol, &price, row_nr) < 0) {
+		anna_error("stock_price_rows_to_file('%s') failed\n", store->group);
+		goto finish;
+	}
+
+	rt = 0;
+
+finish:
+	if (output_fname[0])
+		unlink(output_fname);
+	stock_price_free(&bars);
+	stock_price_free(&price);
+
+	return rt;
+}
+
+static int fetch_symbol_price(int action, const struct price_store *store, const char *sector, const char *symbol, int year, int month, int mday)
+{
+	if (action == FETCH_ACTION_UPDATE)
+		return update_symbol_price(store, sector, symbol, year, month, mday);
+
+	return fetch_symbol_price_since_date(store, sector, symbol, year, month, mday);
+}
+
+int fetch_symbols_price(int action, const struct price_store *store, const char *fname, int symbols_nr, const char **symbols)
 {
 	int year = 0, month = 0, mday = 0;
 	int count = 0;
-	int is_zacks = !strcmp(group, "zacks");
+	int is_zacks = !strcmp(store->group, "zacks");
 	int i;
 
-	/* get last 2 year's price */
-	if (!realtime) {
+	/* get last history_years' price */
+	if (action != FETCH_ACTION_REALTIME) {
 		time_t now_t = time(NULL);
 		struct tm *now_tm = localtime(&now_t);
-		year = 1900 + now_tm->tm_year - stock_history_max_years();
+		year = 1900 + now_tm->tm_year - history_years;
 		month = now_tm->tm_mon;
 		mday = now_tm->tm_mday;
 	}
 
 	if (symbols_nr) {
 		for (i = 0; i < symbols_nr; i++)
-			fetch_symbol_price_since_date(group, NULL, symbols[i], year, month, mday);
+			fetch_symbol_price(action, store, NULL, symbols[i], year, month, mday);
 		return 0;
 	}
 
@@ -218,7 +284,7 @@ int fetch_symbols_price(int realtime, const char *group, const char *fname, int
 		anna_info("\n%s%s: start fetching symbols' price%s\n", ANSI_COLOR_YELLOW, fname, ANSI_COLOR_RESET);
 
 		while (fgets(symbol, sizeof(symbol), fp)) {
-			char sector[64] = { };
+			char sector[160] = { };
 
 			if (symbol[0] == '#' || symbol[0] == '\n')
 				continue;
@@ -229,7 +295,7 @@ int fetch_symbols_price(int realtime, const char *group, const char *fname, int
 
 			if (symbol[0] == '-') {
 				if (strncmp(&symbol[1], "include ", strlen("include ")) == 0)
-					count += fetch_symbols_price(realtime, group, strchr(symbol, ' ') + 1, 0, NULL);
+					count += fetch_symbols_price(action, store, strchr(symbol, ' ') + 1, 0, NULL);
 				continue;
 			}
 			else if (symbol[0] == '%') {
@@ -269,7 +335,7 @@ int fetch_symbols_price(int realtime, const char *group, const char *fname, int
 			else
 				strlcpy(sector, sector_prefix, sizeof(sector));
 
-			if (fetch_symbol_price_since_date(group, sector, symbol, year, month, mday) == 0)
+			if (fetch_symbol_price(action, store, sector, symbol, year, month, mday) == 0)
 				count += 1;
 		}
 
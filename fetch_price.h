@@ -6,12 +6,14 @@ enum
 	FETCH_ACTION_ADD,
 	FETCH_ACTION_DEL,
 	FETCH_ACTION_UPDATE,
+	FETCH_ACTION_REALTIME,
 
 	FETCH_ACTION_NR
 };
 
 struct date_price;
+struct price_store;
 
-int fetch_symbols_price(int realtime, const char *group, const char *fname, int symbols_nr, const char **symbols);
+int fetch_symbols_price(int action, const struct price_store *store, const char *fname, int symbols_nr, const char **symbols);
 
 #endif /* __FECTCH_PRICE_H__ */
@@ -0,0 +1,145 @@
+#include "indicator.h"
+
+#include <string.h>
+
+/* sum of the window ending at bar, its average once the window is full */
+static void window_avg_step(const struct indicator *ind, int row_nr, uint64_t *sum,
+			    uint32_t bar_val, uint32_t leaving_val, uint32_t *value)
+{
+	*sum += bar_val;
+	if (row_nr > ind->days)
+		*sum -= leaving_val;
+	if (row_nr >= ind->days)
+		*value = *sum / ind->days;
+}
+
+static void sma_build(const struct indicator *ind, const struct stock_price *price, int idx, uint64_t *state)
+{
+	int i;
+
+	for (i = idx; i < idx + ind->days && i < price->date_cnt; i++)
+		*state += price->dateprice[i].close;
+}
+
+static void sma_step(const struct indicator *ind, const struct stock_price *price, int idx, int row_nr,
+		     uint64_t *state, const struct date_price *bar, uint32_t *value)
+{
+	uint32_t leaving = row_nr > ind->days ? price->dateprice[idx + ind->days - 1].close : 0;
+
+	window_avg_step(ind, row_nr, state, bar->close, leaving, value);
+}
+
+static void vma_build(const struct indicator *ind, const struct stock_price *price, int idx, uint64_t *state)
+{
+	int i;
+
+	for (i = idx; i < idx + ind->days && i < price->date_cnt; i++)
+		*state += price->dateprice[i].volume;
+}
+
+static void vma_step(const struct indicator *ind, const struct stock_price *price, int idx, int row_nr,
+		     uint64_t *state, const struct date_price *bar, uint32_t *value)
+{
+	uint32_t leaving = row_nr > ind->days ? price->dateprice[idx + ind->days - 1].volume : 0;
+
+	window_avg_step(ind, row_nr, state, bar->volume, leaving, value);
+}
+
+/*
+ * money flow index: a row's raw money flow (typical price * volume) is
+ * positive if its typical price is not below the day before (or it's the
+ * oldest row), negative otherwise. state is the positive and negative flow
+ * of the window.
+ */
+static int mf_is_positive(const struct stock_price *price, int idx)
+{
+	return idx == price->date_cnt - 1
+	       || typical_price(&price->dateprice[idx]) >= typical_price(&price->dateprice[idx + 1]);
+}
+
+static void mfi_build(const struct indicator *ind, const struct stock_price *price, int idx, uint64_t *state)
+{
+	int i;
+
+	for (i = idx; i < idx + ind->days && i < price->date_cnt; i++)
+		state[!mf_is_positive(price, i)] += raw_mf(&price->dateprice[i]);
+}
+
+static void mfi_step(const struct indicator *ind, const struct stock_price *price, int idx, int row_nr,
+		     uint64_t *state, const struct date_price *bar, uint32_t *value)
+{
+	uint64_t *positive_mf = &state[0], *negative_mf = &state[1];
+
+	if (row_nr == 1 || typical_price(bar) >= typical_price(&price->dateprice[idx]))
+		*positive_mf += raw_mf(bar);
+	else
+		*negative_mf += raw_mf(bar);
+
+	/* the day leaving the window */
+	if (row_nr > ind->days) {
+		int leaving = idx + ind->days - 1;
+
+		if (mf_is_positive(price, leaving))
+			*positive_mf -= raw_mf(&price->dateprice[leaving]);
+		else
+			*negative_mf -= raw_mf(&price->dateprice[leaving]);
+	}
+
+	if (row_nr >= ind->days)
+		*value = 10000 - 1000000 / (100 + (*positive_mf * 100 / (*negative_mf ? *negative_mf : 100)));
+}
+
+#define SMA(days) \
+	{ "sma" #days "d", days, 1, offsetof(struct date_price, sma[SMA_##days##d]), { "sma" #days "d" }, 1, \
+	  sma_build, sma_step }
+#define VMA(days) \
+	{ "vma" #days "d", days, 1, offsetof(struct date_price, vma[VMA_##days##d]), { "vma" #days "d" }, 1, \
+	  vma_build, vma_step }
+
+/* in the order of their columns in the text and sqlite formats */
+const struct indicator indicators[] =
+{
+	SMA(10), SMA(20), SMA(30), SMA(50), SMA(60), SMA(100), SMA(120), SMA(200),
+	VMA(10), VMA(20), VMA(60),
+	{ "mfi", 14, 1, offsetof(struct date_price, mfi), { "mfi" }, 2, mfi_build, mfi_step },
+};
+
+const int indicator_nr = sizeof(indicators) / sizeof(indicators[0]);
+
+/* state of every indicator at row idx, see struct price_state */
+void indicators_build(const struct stock_price *price, int idx, struct price_state *state)
+{
+	uint64_t *value = state->value;
+	int k;
+
+	memset(state, 0, sizeof(*state));
+
+	state->date = price->dateprice[idx].date;
+	state->row_nr = price->date_cnt - idx;
+
+	for (k = 0; k < indicator_nr; k++) {
+		indicators[k].build(&indicators[k], price, idx, value);
+		value += indicators[k].state_nr;
+	}
+}
+
+/*
+ * step every indicator from row idx to bar, the day after it, and set
+ * bar's values. only the rows leaving the windows are read.
+ */
+void indicators_step(const struct stock_price *price, int idx, struct price_state *state, struct date_price *bar)
+{
+	int row_nr = price->date_cnt - idx + 1; /* rows from bar to the oldest one */
+	uint64_t *value = state->value;
+	int k;
+
+	for (k = 0; k < indicator_nr; k++) {
+		const struct indicator *ind = &indicators[k];
+
+		ind->step(ind, price, idx, row_nr, value, bar, indicator_value(ind, bar));
+		value += ind->state_nr;
+	}
+
+	state->date = bar->date;
+	state->row_nr = row_nr;
+}
@@ -0,0 +1,64 @@
+#ifndef __INDICATOR_H__
+#define __INDICATOR_H__
+
+#include "stock_price.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * indicators are uint32_t columns of struct date_price computed over a
+ * window of rows, e.g. sma[SMA_20d]. every one in indicators[] is stepped
+ * a row at a time by indicators_step(), so all of them are computed in a
+ * single pass from the oldest row to the latest one, and carried on from
+ * struct price_state for new rows. the text and sqlite price formats take
+ * their columns from indicators[] as well.
+ *
+ * a new indicator is a field of struct date_price, its state slots in
+ * PRICE_STATE_NR and an entry of indicators[].
+ */
+#define INDICATOR_COLUMN_MAX	4
+
+struct indicator
+{
+	const char *name;
+	int days; /* window */
+	int column_nr; /* uint32_t values of struct date_price from offset */
+	size_t offset;
+	const char *column[INDICATOR_COLUMN_MAX]; /* names in the text and sqlite formats */
+	int state_nr; /* uint64_t values of price_state.value[] */
+
+	/* state at row idx, from the rows of its window */
+	void (*build)(const struct indicator *ind, const struct stock_price *price, int idx, uint64_t *state);
+	/*
+	 * add bar, one day newer than row idx (row idx-1 if it's in price
+	 * already, idx is date_cnt for the oldest row), to state and set its
+	 * values. row_nr is the number of rows from bar to the oldest one.
+	 */
+	void (*step)(const struct indicator *ind, const struct stock_price *price, int idx, int row_nr,
+		     uint64_t *state, const struct date_price *bar, uint32_t *value);
+};
+
+extern const struct indicator indicators[];
+extern const int indicator_nr;
+
+/* ind's values of row p */
+static inline uint32_t *indicator_value(const struct indicator *ind, const struct date_price *p)
+{
+	return (uint32_t *)((const char *)p + ind->offset);
+}
+
+static inline uint32_t typical_price(const struct date_price *p)
+{
+	return (p->high + p->low + p->close) / 3;
+}
+
+static inline uint64_t raw_mf(const struct date_price *p)
+{
+	return (uint64_t)typical_price(p) * p->volume;
+}
+
+void indicators_build(const struct stock_price *price, int idx, struct price_state *state);
+void indicators_step(const struct stock_price *price, int idx, struct price_state *state, struct date_price *bar);
+
+#endif /* __INDICATOR_H__ */
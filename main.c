@@ -1,6 +1,10 @@
 #include "util.h"
 #include "fetch_price.h"
 #include "stock_price.h"
+#include "price_file.h"
+#include "price_pack.h"
+#include "price_db.h"
+#include "serve.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -12,6 +16,17 @@
 #include <ctype.h>
 
 static char ticker_list_fname[128];
+static struct check_params check_params = CHECK_PARAMS_INIT;
+static int check_jobs = 1; /* -jobs=N */
+static int price_storage = PRICE_STORAGE_FILE; /* the group's storage= */
+
+/* run by ACTION_CHECK, in the order they are given */
+static int screens[CHECK_SCREEN_MAX];
+static int screen_nr;
+/* the group's screens= of anna.conf, run by 'anna check' */
+static int conf_screens[CHECK_SCREEN_MAX];
+static int conf_screen_nr;
+static int use_conf_screens;
 
 enum
 {
@@ -19,60 +34,32 @@ enum
 
 	ACTION_FETCH,
 	ACTION_FETCH_REALTIME,
-	ACTION_CHECK_SPT, /* support */
-	ACTION_CHECK_SMA20d, /* support at sma20d */
-	ACTION_CHECK_SMA30d, /* support at sma30d */
-	ACTION_CHECK_SMA50d, /* support at sma50d */
-	ACTION_CHECK_SMA60d, /* support at sma60d */
-	ACTION_CHECK_26W_LOW_SMA20d, /* 26 week low cross above sma20 */
-	ACTION_CHECK_26W_LOW_SMA50d, /* 26 week low cross above sma50 */
-	ACTION_CHECK_13W_LOW_SMA20d, /* 13 week low cross above sma20 */
-	ACTION_CHECK_13W_LOW_SMA50d, /* 13 week low cross above sma50 */
-	ACTION_CHECK_SMA10d_UP, /* cross above sma20 */
-	ACTION_CHECK_SMA20d_UP, /* cross above sma20 */
-	ACTION_CHECK_SMA50d_UP, /* cross above sma50 */
-	ACTION_CHECK_SMA200d_UP, /* cross above sma200 */
-	ACTION_CHECK_STRONG_SMA20d_UP,
-	ACTION_CHECK_SMA20d_PULLBACK, /* previous day cross above sma20d, today pullback beneth sma20d */
-	ACTION_CHECK_SMA50d_PULLBACK, /* previous day cross above sma50d, today pullback beneth sma50d */
-	ACTION_CHECK_SMA10d_BREAKOUT, /* breakout sma10d */
-	ACTION_CHECK_SMA20d_BREAKOUT, /* breakout sma20d */
-	ACTION_CHECK_SMA10d_TRENDUP,
-	ACTION_CHECK_DB, /* double bottom */
-	ACTION_CHECK_PULLBACK_DB, /* pullback double bottom */
-	ACTION_CHECK_MFI_DB, /* double bottom with rising money flow index */
-	ACTION_CHECK_52W_DB, /* 52w low double bottom */
-	ACTION_CHECK_52W_DBUP, /* 52w low double bottom up */
-	ACTION_CHECK_DBUP, /* up from double bottom */
-	ACTION_CHECK_PULLBACK_DBUP, /* up from pullback double bottom */
-	ACTION_CHECK_STRONG_DBUP, /* strong up from double bottom */
-	ACTION_CHECK_PB, /* pull back */
-	ACTION_CHECK_BO, /* break out */
-	ACTION_CHECK_2nd_BO, /* 2nd break out */
-	ACTION_CHECK_52W_LOWUP, /* up from 52w low */
-	ACTION_CHECK_CHANGE,
-	ACTION_CHECK_TREND_BO, /* trendline breakout */
-	ACTION_CHECK_STRONG_UPTREND,
-	ACTION_CHECK_STRONG_BO,
-	ACTION_CHECK_STRONG_BODY_BO,
-	ACTION_CHECK_RESIST_BO,
-	ACTION_CHECK_MFI,
-	ACTION_CHECK_REVERSE_UP,
-	ACTION_CHECK_HIGHER_LOW,
+	ACTION_UPDATE, /* fetch and append bars after the latest stored date */
+	ACTION_CONVERT, /* convert text price files to binary format */
+	ACTION_DUMP, /* print price files as text */
+	ACTION_PACK, /* build the group's price pack */
+	ACTION_CHECK, /* screens, see stock_price_check_screens() */
+	ACTION_SERVE, /* keep the histories in memory and run the checks sent to it, see serve.h */
 
 	ACTION_NR
 };
 
 const char *group_list[ ] = { "usa", "iwm", "mdy", "zacks", "ibd", "biotech", "3x", "china", "canada", NULL };
 
+/* -group=all, in the order anna-all.sh ran them */
+static const char *all_group_list[ ] = { "usa", "zacks", "mdy", "biotech", "3x", "canada", NULL };
+
 static void print_usage(void)
 {
-	printf("Usage: anna -group={usa|china|canada|iwm|mdy|biotech|zacks|ibd|3x} [-date=yyyy-mm-dd] [-conf=filename]\n");
-	printf("               {fetch | fetch-rt | check-db | check-mfi-db | check-pullback-db | check-52w-db | "
+	printf("Usage: anna -group={usa|china|canada|iwm|mdy|biotech|zacks|ibd|3x|all} [-date=yyyy-mm-dd] [-conf=filename] [-jobs=N]\n");
+	printf("               {fetch | fetch-rt | update | convert | dump | pack | check-db | check-mfi-db | check-pullback-db | check-52w-db | "
 				"check-dbup | check-pullback-dbup | check-52w-dbup | check-strong-dbup | check-52wlup | check-higher-low"
 				"check-spt | check-20d | check-30d | check-50d | check-60d | check-20dlow | check-50dlow | check-26w20dlow | check-26w50dlow | "
 				"check-10dup | check-20dup | check-strong-20dup | check-50dup | check-200dup | check-20dpb | check-50dpb | check-pb | check-bo | check-2ndbo | "
 				"check-trend-bo | check-strong-uptrend | check-strong-bo | check-10d-trendup | check-resist-bo | check-mfi | check-reverse-upday | check-chg} [symbol-1 symbol-2 ...]\n");
+	printf("       several check-xxx are run in one pass over the symbols; 'check' runs the group's screens= in the conf file\n");
+	printf("       -group=all runs the action for usa, zacks, mdy, biotech, 3x and canada; a check reads a symbol once for all of them\n");
+	printf("       anna [-conf=filename] serve: keep every group in memory, the checks are run by it while it's running\n");
 }
 
 static int init_dirs(const char *group)
@@ -104,6 +91,59 @@ static int init_dirs(const char *group)
 	return 0;
 }
 
+static void add_screen(int *list, int *nr, int screen)
+{
+	int i;
+
+	for (i = 0; i < *nr; i++) {
+		if (list[i] == screen)
+			return;
+	}
+
+	if (*nr == CHECK_SCREEN_MAX) {
+		anna_error("up to %d screens are run at once\n", CHECK_SCREEN_MAX);
+		return;
+	}
+
+	list[(*nr)++] = screen;
+}
+
+/* the screens of the command line, then those of the group's conf if 'check' is given */
+static int group_screens(int *list)
+{
+	int i, nr = 0;
+
+	for (i = 0; i < screen_nr; i++)
+		add_screen(list, &nr, screens[i]);
+
+	if (use_conf_screens) {
+		for (i = 0; i < conf_screen_nr; i++)
+			add_screen(list, &nr, conf_screens[i]);
+	}
+
+	return nr;
+}
+
+/* screens=check-xxx,check-yyy,... */
+static void load_conf_screens(char *list)
+{
+	char *name;
+
+	conf_screen_nr = 0;
+
+	for (name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+		int screen = stock_price_screen_find(name);
+
+		if (screen < 0) {
+			anna_error("unknown screen %s\n", name);
+			continue;
+		}
+
+		if (conf_screen_nr < CHECK_SCREEN_MAX)
+			conf_screens[conf_screen_nr++] = screen;
+	}
+}
+
 static int load_config_file(const char *fname, const char *group)
 {
 	char buf[512];
@@ -118,6 +158,15 @@ static int load_config_file(const char *fname, const char *group)
 		return -1;
 	}
 
+	/* the defaults for what the group doesn't set, -group=all loads one group after another */
+	ticker_list_fname[0] = 0;
+	check_params = (struct check_params)CHECK_PARAMS_INIT;
+	check_params.jobs = check_jobs;
+	conf_screen_nr = 0;
+	history_years = 1;
+	fetch_source = FETCH_SOURCE_YAHOO;
+	price_storage = PRICE_STORAGE_FILE;
+
 	while (fgets(buf, sizeof(buf), fp)) {
 		char *p;
 
@@ -144,17 +193,33 @@ static int load_config_file(const char *fname, const char *group)
 			}
 			else if (strncmp(buf, "sr_height_margin=", strlen("sr_height_margin=")) == 0) {
 				p = strchr(buf, '=');
-				sr_height_margin = atoi(p + 1);
+				check_params.sr_height_margin = atoi(p + 1);
 			}
 			else if (strncmp(buf, "spt_pullback_margin=", strlen("spt_pullback_margin=")) == 0) {
 				p = strchr(buf, '=');
-				spt_pullback_margin = atoi(p + 1);
+				check_params.spt_pullback_margin = atoi(p + 1);
+			}
+			else if (strncmp(buf, "history_years=", strlen("history_years=")) == 0) {
+				p = strchr(buf, '=');
+				if (atoi(p + 1) > 0)
+					history_years = atoi(p + 1);
 			}
 			else if (strncmp(buf, "fetch_source=", strlen("fetch_source=")) == 0) {
 				p = strchr(buf, '=');
 				if (*(p + 1) == 'g')
 					fetch_source = FETCH_SOURCE_GOOGLE;
 			}
+			else if (strncmp(buf, "screens=", strlen("screens=")) == 0) {
+				p = strchr(buf, '=');
+				load_conf_screens(p + 1);
+			}
+			else if (strncmp(buf, "storage=", strlen("storage=")) == 0) {
+				p = strchr(buf, '=');
+				if (strcmp(p + 1, "pack") == 0)
+					price_storage = PRICE_STORAGE_PACK;
+				else if (strcmp(p + 1, "sqlite") == 0)
+					price_storage = PRICE_STORAGE_SQLITE;
+			}
 		}
 	}
 
@@ -163,17 +228,153 @@ static int load_config_file(const char *fname, const char *group)
 	return 0;
 }
 
-int main(int argc, const char **argv)
+/* the check of group by its conf just loaded, -1 if it has no screens */
+static int load_check_group(const char *name, struct check_group *group)
+{
+	memset(group, 0, sizeof(*group));
+
+	group->screen_nr = group_screens(group->screens);
+	if (!group->screen_nr) {
+		anna_error("no screens= for group %s in the conf file\n", name);
+		return -1;
+	}
+
+	strlcpy(group->name, name, sizeof(group->name));
+	group->storage = price_storage;
+	group->params = check_params;
+
+	/* the histories in memory if it's run by 'anna serve' */
+	serve_histories(group);
+
+	return 0;
+}
+
+static void run_action(int action, const char *conf_fname, const char *group, const char *date,
+		       int symbols_nr, const char **symbols)
+{
+	struct price_store store = { group, NULL };
+	struct check_group check_group;
+
+	if (init_dirs(group) < 0)
+		return;
+
+	if (load_config_file(conf_fname, group) < 0)
+		return;
+
+	/* a check opens the database of each of its groups itself */
+	if (price_storage == PRICE_STORAGE_SQLITE && action != ACTION_CHECK) {
+		store.db = price_db_open(group);
+		if (!store.db)
+			return;
+	}
+
+	switch (action) {
+	case ACTION_FETCH:
+	case ACTION_UPDATE:
+		if (store.db)
+			price_db_begin(store.db);
+		fetch_symbols_price(action == ACTION_FETCH ? FETCH_ACTION_ADD : FETCH_ACTION_UPDATE, &store, ticker_list_fname, symbols_nr, symbols);
+		if (store.db)
+			price_db_commit(store.db);
+		if (price_storage == PRICE_STORAGE_PACK)
+			price_pack_build(group);
+		break;
+
+	case ACTION_FETCH_REALTIME:
+		fetch_symbols_price(FETCH_ACTION_REALTIME, &store, ticker_list_fname, symbols_nr, symbols);
+		break;
+
+	case ACTION_CONVERT:
+		price_file_convert(group);
+		break;
+
+	case ACTION_PACK:
+		if (price_pack_build(group) >= 0)
+			anna_info("%s%s: price pack is built%s\n", ANSI_COLOR_YELLOW, group, ANSI_COLOR_RESET);
+		break;
+
+	case ACTION_DUMP:
+		stock_price_dump(&store, symbols_nr, symbols);
+		break;
+
+	case ACTION_CHECK:
+		if (load_check_group(group, &check_group) == 0)
+			stock_price_check_screens(&check_group, date, symbols_nr, symbols);
+		break;
+	}
+
+	price_db_close(store.db);
+}
+
+/* the groups of -group=all with their conf, checked at once */
+static void check_all_groups(const char *conf_fname, const char *date, int symbols_nr, const char **symbols)
+{
+	struct check_group groups[CHECK_GROUP_MAX];
+	int group_nr = 0;
+	int i;
+
+	for (i = 0; all_group_list[i] && group_nr < CHECK_GROUP_MAX; i++) {
+		if (init_dirs(all_group_list[i]) < 0 || load_config_file(conf_fname, all_group_list[i]) < 0)
+			continue;
+
+		if (load_check_group(all_group_list[i], &groups[group_nr]) == 0)
+			group_nr += 1;
+	}
+
+	stock_price_check_groups(date, check_jobs, group_nr, groups, symbols_nr, symbols);
+}
+
+static int anna_main(int argc, const char **argv, int in_daemon);
+
+static int serve_run(int argc, const char **argv)
+{
+	return anna_main(argc, argv, 1);
+}
+
+/* 'anna serve': every group in memory, read as its storage= says */
+static void serve_groups(const char *conf_fname)
+{
+	int i, rt;
+
+	/* before every history is read for nothing */
+	rt = serve_running();
+	if (rt) {
+		if (rt > 0)
+			anna_error("a daemon is serving on %s already\n", SERVE_SOCKET);
+		return;
+	}
+
+	for (i = 0; group_list[i]; i++) {
+		if (init_dirs(group_list[i]) < 0 || load_config_file(conf_fname, group_list[i]) < 0)
+			return;
+
+		serve_load(group_list[i], price_storage);
+	}
+
+	serve_loop(serve_run);
+}
+
+/*
+ * run the action of argv. a check is sent to 'anna serve' if it's running,
+ * in_daemon is set for the checks it runs then.
+ */
+static int anna_main(int argc, const char **argv, int in_daemon)
 {
 	char group[16] = { 0 };
 	char date[12] = { 0 };
 	char conf_fname[64] = { 0 };
+	uint32_t date_value;
 	int action = ACTION_NONE;
 	char *symbols[256] = { NULL };
 	int symbols_nr = 0;
 	char *p;
 	int i;
 
+	/* the daemon runs one check after another */
+	screen_nr = 0;
+	use_conf_screens = 0;
+	check_jobs = 1;
+
 	for (i = 1; i < argc; i++) {
 		const char *arg = argv[i];
 
@@ -187,125 +388,28 @@ int main(int argc, const char **argv)
 			else if (strcmp(arg, "fetch-rt") == 0) {
 				action = ACTION_FETCH_REALTIME;
 			}
-			else if (strcmp(arg, "check-spt") == 0) {
-				action = ACTION_CHECK_SPT;
-			}
-			else if (strcmp(arg, "check-20d") == 0) {
-				action = ACTION_CHECK_SMA20d;
-			}
-			else if (strcmp(arg, "check-30d") == 0) {
-				action = ACTION_CHECK_SMA30d;
-			}
-			else if (strcmp(arg, "check-50d") == 0) {
-				action = ACTION_CHECK_SMA50d;
-			}
-			else if (strcmp(arg, "check-60d") == 0) {
-				action = ACTION_CHECK_SMA60d;
-			}
-			else if (strcmp(arg, "check-20dlow") == 0) {
-				action = ACTION_CHECK_13W_LOW_SMA20d;
-			}
-			else if (strcmp(arg, "check-50dlow") == 0) {
-				action = ACTION_CHECK_13W_LOW_SMA50d;
-			}
-			else if (strcmp(arg, "check-26w20dlow") == 0) {
-				action = ACTION_CHECK_26W_LOW_SMA20d;
-			}
-			else if (strcmp(arg, "check-26w50dlow") == 0) {
-				action = ACTION_CHECK_26W_LOW_SMA50d;
-			}
-			else if (strcmp(arg, "check-10dup") == 0) {
-				action = ACTION_CHECK_SMA10d_UP;
-			}
-			else if (strcmp(arg, "check-20dup") == 0) {
-				action = ACTION_CHECK_SMA20d_UP;
-			}
-			else if (strcmp(arg, "check-strong-20dup") == 0) {
-				action = ACTION_CHECK_STRONG_SMA20d_UP;
-			}
-			else if (strcmp(arg, "check-50dup") == 0) {
-				action = ACTION_CHECK_SMA50d_UP;
-			}
-			else if (strcmp(arg, "check-200dup") == 0) {
-				action = ACTION_CHECK_SMA200d_UP;
-			}
-			else if (strcmp(arg, "check-20dpb") == 0) {
-				action = ACTION_CHECK_SMA20d_PULLBACK;
-			}
-			else if (strcmp(arg, "check-50dpb") == 0) {
-				action = ACTION_CHECK_SMA50d_PULLBACK;
-			}
-			else if (strcmp(arg, "check-10d-bo") == 0) {
-				action = ACTION_CHECK_SMA10d_BREAKOUT;
-			}
-			else if (strcmp(arg, "check-20d-bo") == 0) {
-				action = ACTION_CHECK_SMA20d_BREAKOUT;
-			}
-			else if (strcmp(arg, "check-10d-trendup") == 0) {
-				action = ACTION_CHECK_SMA10d_TRENDUP;
-			}
-			else if (strcmp(arg, "check-db") == 0) {
-				action = ACTION_CHECK_DB;
-			}
-			else if (strcmp(arg, "check-mfi-db") == 0) {
-				action = ACTION_CHECK_MFI_DB;
-			}
-			else if (strcmp(arg, "check-pullback-db") == 0) {
-				action = ACTION_CHECK_PULLBACK_DB;
-			}
-			else if (strcmp(arg, "check-52w-db") == 0) {
-				action = ACTION_CHECK_52W_DB;
-			}
-			else if (strcmp(arg, "check-52w-dbup") == 0) {
-				action = ACTION_CHECK_52W_DBUP;
+			else if (strcmp(arg, "update") == 0) {
+				action = ACTION_UPDATE;
 			}
-			else if (strcmp(arg, "check-dbup") == 0) {
-				action = ACTION_CHECK_DBUP;
+			else if (strcmp(arg, "convert") == 0) {
+				action = ACTION_CONVERT;
 			}
-			else if (strcmp(arg, "check-pullback-dbup") == 0) {
-				action = ACTION_CHECK_PULLBACK_DBUP;
+			else if (strcmp(arg, "dump") == 0) {
+				action = ACTION_DUMP;
 			}
-			else if (strcmp(arg, "check-strong-dbup") == 0) {
-				action = ACTION_CHECK_STRONG_DBUP;
+			else if (strcmp(arg, "pack") == 0) {
+				action = ACTION_PACK;
 			}
-			else if (strcmp(arg, "check-pb") == 0) {
-				action = ACTION_CHECK_PB;
+			else if (strcmp(arg, "serve") == 0) {
+				action = ACTION_SERVE;
 			}
-			else if (strcmp(arg, "check-52wlup") == 0) {
-				action = ACTION_CHECK_52W_LOWUP;
+			else if (strcmp(arg, "check") == 0) {
+				action = ACTION_CHECK;
+				use_conf_screens = 1;
 			}
-			else if (strcmp(arg, "check-bo") == 0) {
-				action = ACTION_CHECK_BO;
-			}
-			else if (strcmp(arg, "check-2ndbo") == 0) {
-				action = ACTION_CHECK_2nd_BO;
-			}
-			else if (strcmp(arg, "check-trend-bo") == 0) {
-				action = ACTION_CHECK_TREND_BO;
-			}
-			else if (strcmp(arg, "check-strong-uptrend") == 0) {
-				action = ACTION_CHECK_STRONG_UPTREND;
-			}
-			else if (strcmp(arg, "check-strong-bo") == 0) {
-				action = ACTION_CHECK_STRONG_BO;
-			}
-			else if (strcmp(arg, "check-strong-body-bo") == 0) {
-				action = ACTION_CHECK_STRONG_BODY_BO;
-			}
-			else if (strcmp(arg, "check-resist-bo") == 0) {
-				action = ACTION_CHECK_RESIST_BO;
-			}
-			else if (strcmp(arg, "check-chg") == 0) {
-				action = ACTION_CHECK_CHANGE;
-			}
-			else if (strcmp(arg, "check-mfi") == 0) {
-				action = ACTION_CHECK_MFI;
-			}
-			else if (strcmp(arg, "check-reverse-up") == 0) {
-				action = ACTION_CHECK_REVERSE_UP;
-			}
-			else if (strcmp(arg, "check-higher-low") == 0) {
-				action = ACTION_CHECK_HIGHER_LOW;
+			else if (stock_price_screen_find(arg) >= 0) {
+				action = ACTION_CHECK;
+				add_screen(screens, &screen_nr, stock_price_screen_find(arg));
 			}
 		}
 		else if (strncmp(arg, "-group=", strlen("-group=")) == 0) {
@@ -323,200 +427,59 @@ int main(int argc, const char **argv)
 			p = strchr(arg, '=');
 			strlcpy(conf_fname, p + 1, sizeof(conf_fname));
 		}
+		else if (strncmp(arg, "-jobs=", strlen("-jobs=")) == 0) {
+			p = strchr(arg, '=');
+			if (atoi(p + 1) > 0)
+				check_jobs = atoi(p + 1);
+		}
+	}
+
+	if (action == ACTION_SERVE && !in_daemon) {
+		serve_groups(conf_fname);
+		goto finish;
 	}
 
-	if (action == ACTION_NONE || group[0] == 0)
+	if (action == ACTION_NONE || group[0] == 0 || stock_date_from_str(date, &date_value) < 0)
 	{
 		print_usage( );
 		goto finish;
 	}
 
-	if (group[0]) {
-		for (i = 0; group_list[i]; i++) {
-			if (strcmp(group, group_list[i]) == 0)
-				break;
-		}
-
-		if (group_list[i] == NULL) {
-			print_usage( );
-			goto finish;
-		}
+	if (in_daemon && action != ACTION_CHECK) {
+		anna_error("only checks are run by anna serve\n");
+		goto finish;
 	}
 
-	if (init_dirs(group) < 0)
-			goto finish;
-
-	if (load_config_file(conf_fname, group) < 0)
+	if (!in_daemon && action == ACTION_CHECK && serve_request(argc, argv) == 0)
 		goto finish;
 
-	switch (action) {
-	case ACTION_FETCH:
-		fetch_symbols_price(0, group, ticker_list_fname, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_FETCH_REALTIME:
-		fetch_symbols_price(1, group, ticker_list_fname, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SPT:
-		stock_price_check_support(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA20d:
-		stock_price_check_sma(group, date, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA30d:
-		stock_price_check_sma(group, date, SMA_30d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA50d:
-		stock_price_check_sma(group, date, SMA_50d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA60d:
-		stock_price_check_sma(group, date, SMA_60d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_26W_LOW_SMA20d:
-		stock_price_check_weeks_low_sma(group, date, 26, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_26W_LOW_SMA50d:
-		stock_price_check_weeks_low_sma(group, date, 26, SMA_50d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_13W_LOW_SMA20d:
-		stock_price_check_weeks_low_sma(group, date, 13, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_13W_LOW_SMA50d:
-		stock_price_check_weeks_low_sma(group, date, 13, SMA_50d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA10d_UP:
-		stock_price_check_weeks_low_sma(group, date, 0, SMA_10d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA20d_UP:
-		stock_price_check_weeks_low_sma(group, date, 0, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA50d_UP:
-		stock_price_check_sma_up(group, date, SMA_50d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA200d_UP:
-		stock_price_check_weeks_low_sma(group, date, 0, SMA_200d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA20d_PULLBACK:
-		stock_price_check_sma_pullback(group, date, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA50d_PULLBACK:
-		stock_price_check_sma_pullback(group, date, SMA_50d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA10d_BREAKOUT:
-		stock_price_check_sma_breakout(group, date, SMA_10d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA20d_BREAKOUT:
-		stock_price_check_sma_breakout(group, date, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_STRONG_SMA20d_UP:
-		stock_price_check_strong_sma_up(group, date, SMA_20d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_SMA10d_TRENDUP:
-		stock_price_check_sma_trendup(group, date, SMA_10d, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_DB:
-		stock_price_check_doublebottom(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_MFI_DB:
-		stock_price_check_mfi_doublebottom(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_PULLBACK_DB:
-		stock_price_check_pullback_doublebottom(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_52W_DB:
-		stock_price_check_52w_doublebottom(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_52W_DBUP:
-		stock_price_check_52w_doublebottom_up(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_DBUP:
-		stock_price_check_doublebottom_up(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_PULLBACK_DBUP:
-		stock_price_check_pullback_doublebottom_up(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_STRONG_DBUP:
-		stock_price_check_strong_doublebottom_up(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_PB:
-		stock_price_check_pullback(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_BO:
-		stock_price_check_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_2nd_BO:
-		stock_price_check_2nd_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_52W_LOWUP:
-                stock_price_check_52w_low_up(group, date, symbols_nr, (const char **)symbols);
-                break;
-
-	case ACTION_CHECK_CHANGE:
-		stock_price_check_change(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_TREND_BO:
-		stock_price_check_trend_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
-	case ACTION_CHECK_STRONG_UPTREND:
-		stock_price_check_strong_uptrend(group, date, symbols_nr, (const char **)symbols);
-		break;
-
-	case ACTION_CHECK_STRONG_BO:
-		stock_price_check_strong_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
-	case ACTION_CHECK_STRONG_BODY_BO:
-		stock_price_check_strong_body_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
+	if (strcmp(group, "all") == 0) {
+		if (action == ACTION_CHECK) {
+			check_all_groups(conf_fname, date, symbols_nr, (const char **)symbols);
+			goto finish;
+		}
 
-	case ACTION_CHECK_RESIST_BO:
-		stock_price_check_resist_breakout(group, date, symbols_nr, (const char **)symbols);
-		break;
+		for (i = 0; all_group_list[i]; i++) {
+			anna_info("group=%s\n", all_group_list[i]);
+			run_action(action, conf_fname, all_group_list[i], date, symbols_nr, (const char **)symbols);
+			anna_info("\n");
+		}
 
-	case ACTION_CHECK_MFI:
-		stock_price_check_mfi(group, date, symbols_nr, (const char **)symbols);
-		break;
+		goto finish;
+	}
 
-	case ACTION_CHECK_REVERSE_UP:
-		stock_price_check_reverse_up(group, date, symbols_nr, (const char **)symbols);
-		break;
+	for (i = 0; group_list[i]; i++) {
+		if (strcmp(group, group_list[i]) == 0)
+			break;
+	}
 
-	case ACTION_CHECK_HIGHER_LOW:
-		stock_price_check_higher_low(group, date, symbols_nr, (const char **)symbols);
-		break;
+	if (group_list[i] == NULL) {
+		print_usage( );
+		goto finish;
 	}
 
+	run_action(action, conf_fname, group, date, symbols_nr, (const char **)symbols);
+
 finish:
 	for (i = 0; i < symbols_nr; i++) {
 		if (symbols[i])
@@ -525,3 +488,8 @@ finish:
 
 	return 0;
 }
+
+int main(int argc, const char **argv)
+{
+	return anna_main(argc, argv, 0);
+}
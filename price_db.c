@@ -0,0 +1,591 @@
+#include "price_db.h"
+#include "stock_price.h"
+
+#include "util.h"
+#include "indicator.h"
+#include "sqlite3.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* columns of table 'price' before and after the indicator ones, see price_db.price_columns */
+#define PRICE_COLUMNS_HEAD	"date, wday, open, high, low, close, volume"
+#define PRICE_COLUMNS_TAIL \
+	"typical_price, raw_mf, candle_color, candle_trend, sr_flag, " \
+	"height_low_spt, height_2ndlow_spt, height_high_rst, height_2ndhigh_rst"
+#define PRICE_COLUMNS_FIXED_NR	16
+
+static const char *schema =
+	"PRAGMA journal_mode=WAL;"
+	"PRAGMA synchronous=OFF;"
+	"CREATE TABLE IF NOT EXISTS symbol ("
+	"  symbol TEXT PRIMARY KEY, sector TEXT"
+	") WITHOUT ROWID;"
+	"CREATE TABLE IF NOT EXISTS price ("
+	"  symbol TEXT NOT NULL, date INTEGER NOT NULL, wday INTEGER,"
+	"  open INTEGER, high INTEGER, low INTEGER, close INTEGER, volume INTEGER,"
+	"  typical_price INTEGER, raw_mf INTEGER,"
+	"  candle_color INTEGER, candle_trend INTEGER, sr_flag INTEGER,"
+	"  height_low_spt INTEGER, height_2ndlow_spt INTEGER,"
+	"  height_high_rst INTEGER, height_2ndhigh_rst INTEGER,"
+	"  PRIMARY KEY (symbol, date)"
+	") WITHOUT ROWID;"
+	"CREATE TABLE IF NOT EXISTS state ("
+	"  symbol TEXT PRIMARY KEY, state BLOB"
+	") WITHOUT ROWID;";
+
+/* a group's open database, with its statements prepared */
+struct price_db
+{
+	sqlite3 *sqlite;
+	sqlite3_stmt *stmt_insert_symbol;
+	sqlite3_stmt *stmt_delete_price;
+	sqlite3_stmt *stmt_insert_price;
+	sqlite3_stmt *stmt_select_price;
+	sqlite3_stmt *stmt_select_symbol;
+	sqlite3_stmt *stmt_peek_price;
+	sqlite3_stmt *stmt_insert_state;
+	sqlite3_stmt *stmt_select_state;
+
+	/* all columns of table 'price' but symbol, the indicator ones from indicators[] */
+	char price_columns[1024];
+	int price_column_nr;
+};
+
+/*
+ * sqlite3.lib is built with SQLITE_THREADSAFE=0, it has no locks of its
+ * own: every call into it, through any handle, is made under this one.
+ */
+static pthread_mutex_t price_db_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int prepare(struct price_db *db, const char *sql, sqlite3_stmt **stmt)
+{
+	if (sqlite3_prepare_v2(db->sqlite, sql, -1, stmt, NULL) != SQLITE_OK) {
+		anna_error("sqlite3_prepare_v2(%s) failed: %s\n", sql, sqlite3_errmsg(db->sqlite));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int price_db_exec(struct price_db *db, const char *sql)
+{
+	char *errmsg = NULL;
+
+	if (sqlite3_exec(db->sqlite, sql, NULL, NULL, &errmsg) != SQLITE_OK) {
+		anna_error("sqlite3_exec(%s) failed: %s\n", sql, errmsg);
+		sqlite3_free(errmsg);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* append str to sql of size sz, -1 if it doesn't fit */
+static int sql_append(char *sql, size_t sz, const char *str)
+{
+	size_t len = strlen(sql);
+
+	if (len + strlen(str) >= sz) {
+		anna_error("sql too long: %s%s\n", sql, str);
+		return -1;
+	}
+
+	strcpy(sql + len, str);
+
+	return 0;
+}
+
+/*
+ * add the indicator columns table 'price' doesn't have yet, e.g. of an
+ * indicator added since it was created. rows already stored read them as 0
+ * until they are written again. builds db->price_columns.
+ */
+static int price_db_columns(struct price_db *db)
+{
+	char sql[256];
+	int i, k;
+
+	db->price_columns[0] = 0;
+	db->price_column_nr = PRICE_COLUMNS_FIXED_NR;
+
+	if (sql_append(db->price_columns, sizeof(db->price_columns), PRICE_COLUMNS_HEAD) < 0)
+		return -1;
+
+	for (k = 0; k < indicator_nr; k++) {
+		for (i = 0; i < indicators[k].column_nr; i++) {
+			const char *column = indicators[k].column[i];
+			sqlite3_stmt *stmt;
+
+			if (sql_append(db->price_columns, sizeof(db->price_columns), ", ") < 0
+			    || sql_append(db->price_columns, sizeof(db->price_columns), column) < 0)
+				return -1;
+
+			db->price_column_nr += 1;
+
+			snprintf(sql, sizeof(sql), "SELECT %s FROM price LIMIT 0", column);
+			if (sqlite3_prepare_v2(db->sqlite, sql, -1, &stmt, NULL) == SQLITE_OK) {
+				sqlite3_finalize(stmt);
+				continue;
+			}
+
+			snprintf(sql, sizeof(sql), "ALTER TABLE price ADD COLUMN %s INTEGER", column);
+			if (price_db_exec(db, sql) < 0)
+				return -1;
+		}
+	}
+
+	return sql_append(db->price_columns, sizeof(db->price_columns), ", " PRICE_COLUMNS_TAIL);
+}
+
+static void __price_db_close(struct price_db *db);
+
+static struct price_db *__price_db_open(const char *group)
+{
+	struct price_db *db;
+	char fname[128];
+	char sql_insert[2048], sql_select[2048];
+	char *errmsg = NULL;
+	int i;
+
+	db = calloc(1, sizeof(*db));
+	if (!db) {
+		anna_error("calloc(%zu) failed\n", sizeof(*db));
+		return NULL;
+	}
+
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s.db", group);
+
+	if (sqlite3_open(fname, &db->sqlite) != SQLITE_OK) {
+		anna_error("sqlite3_open(%s) failed: %s\n", fname, sqlite3_errmsg(db->sqlite));
+		goto error;
+	}
+
+	if (sqlite3_exec(db->sqlite, schema, NULL, NULL, &errmsg) != SQLITE_OK) {
+		anna_error("create schema of %s failed: %s\n", fname, errmsg);
+		sqlite3_free(errmsg);
+		goto error;
+	}
+
+	if (price_db_columns(db) < 0)
+		goto error;
+
+	snprintf(sql_insert, sizeof(sql_insert), "INSERT OR REPLACE INTO price (symbol, %s) VALUES (?", db->price_columns);
+	for (i = 0; i < db->price_column_nr; i++) {
+		if (sql_append(sql_insert, sizeof(sql_insert), ", ?") < 0)
+			goto error;
+	}
+	if (sql_append(sql_insert, sizeof(sql_insert), ")") < 0)
+		goto error;
+
+	snprintf(sql_select, sizeof(sql_select), "SELECT %s FROM price WHERE symbol = ?1 ORDER BY date DESC", db->price_columns);
+
+	if (prepare(db, "INSERT OR REPLACE INTO symbol (symbol, sector) VALUES (?1, ?2)", &db->stmt_insert_symbol) < 0
+	    || prepare(db, "DELETE FROM price WHERE symbol = ?1", &db->stmt_delete_price) < 0
+	    || prepare(db, sql_insert, &db->stmt_insert_price) < 0
+	    || prepare(db, sql_select, &db->stmt_select_price) < 0
+	    || prepare(db, "SELECT sector FROM symbol WHERE symbol = ?1", &db->stmt_select_symbol) < 0
+	    || prepare(db, "SELECT count(*), max(date) FROM price WHERE symbol = ?1", &db->stmt_peek_price) < 0
+	    || prepare(db, "INSERT OR REPLACE INTO state (symbol, state) VALUES (?1, ?2)", &db->stmt_insert_state) < 0
+	    || prepare(db, "SELECT state FROM state WHERE symbol = ?1", &db->stmt_select_state) < 0)
+	{
+		goto error;
+	}
+
+	return db;
+
+error:
+	__price_db_close(db);
+	return NULL;
+}
+
+static void __price_db_close(struct price_db *db)
+{
+	sqlite3_finalize(db->stmt_insert_symbol);
+	sqlite3_finalize(db->stmt_delete_price);
+	sqlite3_finalize(db->stmt_insert_price);
+	sqlite3_finalize(db->stmt_select_price);
+	sqlite3_finalize(db->stmt_select_symbol);
+	sqlite3_finalize(db->stmt_peek_price);
+	sqlite3_finalize(db->stmt_insert_state);
+	sqlite3_finalize(db->stmt_select_state);
+
+	sqlite3_close(db->sqlite);
+	free(db);
+}
+
+/* open group's database, NULL on error */
+struct price_db *price_db_open(const char *group)
+{
+	struct price_db *db;
+
+	pthread_mutex_lock(&price_db_lock);
+	db = __price_db_open(group);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return db;
+}
+
+void price_db_close(struct price_db *db)
+{
+	if (!db)
+		return;
+
+	pthread_mutex_lock(&price_db_lock);
+	__price_db_close(db);
+	pthread_mutex_unlock(&price_db_lock);
+}
+
+static int price_db_exec_locked(struct price_db *db, const char *sql)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = price_db_exec(db, sql);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+/* batch all writes of a fetch into one transaction */
+int price_db_begin(struct price_db *db)
+{
+	return price_db_exec_locked(db, "BEGIN");
+}
+
+int price_db_commit(struct price_db *db)
+{
+	return price_db_exec_locked(db, "COMMIT");
+}
+
+/* copy symbol's sector if sector is not NULL, returns 1 if symbol is stored */
+static int price_db_symbol(struct price_db *db, const char *symbol, char *sector, int sector_sz)
+{
+	int rt;
+
+	sqlite3_bind_text(db->stmt_select_symbol, 1, symbol, -1, SQLITE_STATIC);
+	rt = sqlite3_step(db->stmt_select_symbol) == SQLITE_ROW;
+	if (rt && sector) {
+		const char *s = (const char *)sqlite3_column_text(db->stmt_select_symbol, 0);
+		strlcpy(sector, s ? s : "", sector_sz);
+	}
+	sqlite3_reset(db->stmt_select_symbol);
+	sqlite3_clear_bindings(db->stmt_select_symbol);
+
+	return rt;
+}
+
+int price_db_has_symbol(struct price_db *db, const char *symbol)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = price_db_symbol(db, symbol, NULL, 0);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+/* symbol's sector, number of rows and latest date without reading its rows, -1 if it's not stored */
+int price_db_peek(struct price_db *db, const char *symbol, char *sector, int sector_sz,
+		  uint32_t *date_cnt, uint32_t *date)
+{
+	sqlite3_stmt *stmt = db->stmt_peek_price;
+	int rt = -1;
+
+	*date_cnt = 0;
+	*date = 0;
+
+	pthread_mutex_lock(&price_db_lock);
+
+	if (price_db_symbol(db, symbol, sector, sector_sz)) {
+		sqlite3_bind_text(stmt, 1, symbol, -1, SQLITE_STATIC);
+		if (sqlite3_step(stmt) == SQLITE_ROW) {
+			*date_cnt = sqlite3_column_int(stmt, 0);
+			*date = sqlite3_column_int(stmt, 1);
+		}
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+
+		rt = 0;
+	}
+
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+static int step_done(struct price_db *db, sqlite3_stmt *stmt)
+{
+	int rt = sqlite3_step(stmt);
+
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	if (rt != SQLITE_DONE) {
+		anna_error("sqlite3_step(%s) failed: %s\n", sqlite3_sql(stmt), sqlite3_errmsg(db->sqlite));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int price_db_insert(struct price_db *db, const char *symbol, const struct stock_price *price, int row_nr)
+{
+	int i, j, k;
+
+	for (i = 0; i < row_nr; i++) {
+		const struct date_price *p = &price->dateprice[i];
+		const struct date_price_cold *c = &price->cold[i];
+		int col = 1;
+
+		sqlite3_bind_text(db->stmt_insert_price, col++, symbol, -1, SQLITE_STATIC);
+		sqlite3_bind_int(db->stmt_insert_price, col++, p->date);
+		sqlite3_bind_int(db->stmt_insert_price, col++, c->wday);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, p->open);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, p->high);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, p->low);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, p->close);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, p->volume);
+		for (k = 0; k < indicator_nr; k++) {
+			const uint32_t *value = indicator_value(&indicators[k], p);
+
+			for (j = 0; j < indicators[k].column_nr; j++)
+				sqlite3_bind_int64(db->stmt_insert_price, col++, value[j]);
+		}
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->typical_price);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->raw_mf);
+		sqlite3_bind_int(db->stmt_insert_price, col++, p->candle_color);
+		sqlite3_bind_int(db->stmt_insert_price, col++, p->candle_trend);
+		sqlite3_bind_int(db->stmt_insert_price, col++, p->sr_flag);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->height_low_spt);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->height_2ndlow_spt);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->height_high_rst);
+		sqlite3_bind_int64(db->stmt_insert_price, col++, c->height_2ndhigh_rst);
+
+		if (step_done(db, db->stmt_insert_price) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int price_db_write_symbol(struct price_db *db, const char *symbol, const char *sector)
+{
+	sqlite3_bind_text(db->stmt_insert_symbol, 1, symbol, -1, SQLITE_STATIC);
+	sqlite3_bind_text(db->stmt_insert_symbol, 2, sector ? sector : "", -1, SQLITE_STATIC);
+
+	return step_done(db, db->stmt_insert_symbol);
+}
+
+/* the state is stored as is, in host byte order like the price files */
+static int price_db_write_state(struct price_db *db, const char *symbol, const struct stock_price *price)
+{
+	if (!stock_price_state_valid(price))
+		return 0;
+
+	sqlite3_bind_text(db->stmt_insert_state, 1, symbol, -1, SQLITE_STATIC);
+	sqlite3_bind_blob(db->stmt_insert_state, 2, &price->state, sizeof(price->state), SQLITE_STATIC);
+
+	return step_done(db, db->stmt_insert_state);
+}
+
+static void price_db_read_state(struct price_db *db, const char *symbol, struct stock_price *price)
+{
+	sqlite3_stmt *stmt = db->stmt_select_state;
+
+	price->state.date = 0;
+
+	sqlite3_bind_text(stmt, 1, symbol, -1, SQLITE_STATIC);
+
+	if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_bytes(stmt, 0) == sizeof(price->state))
+		memcpy(&price->state, sqlite3_column_blob(stmt, 0), sizeof(price->state));
+
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
+
+static int __price_db_write(struct price_db *db, const char *symbol, const char *sector, const struct stock_price *price)
+{
+	if (price_db_write_symbol(db, symbol, sector) < 0)
+		return -1;
+
+	sqlite3_bind_text(db->stmt_delete_price, 1, symbol, -1, SQLITE_STATIC);
+	if (step_done(db, db->stmt_delete_price) < 0)
+		return -1;
+
+	if (price_db_insert(db, symbol, price, price->date_cnt) < 0)
+		return -1;
+
+	return price_db_write_state(db, symbol, price);
+}
+
+static int __price_db_write_rows(struct price_db *db, const char *symbol, const char *sector,
+				 const struct stock_price *price, int row_nr)
+{
+	if (price_db_write_symbol(db, symbol, sector) < 0)
+		return -1;
+
+	if (price_db_insert(db, symbol, price, row_nr < price->date_cnt ? row_nr : price->date_cnt) < 0)
+		return -1;
+
+	return price_db_write_state(db, symbol, price);
+}
+
+int price_db_write(struct price_db *db, const char *symbol, const char *sector, const struct stock_price *price)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = __price_db_write(db, symbol, sector, price);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+/* replace the row_nr latest rows of symbol, older rows are kept */
+int price_db_write_rows(struct price_db *db, const char *symbol, const char *sector,
+			const struct stock_price *price, int row_nr)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = __price_db_write_rows(db, symbol, sector, price, row_nr);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+/*
+ * load symbol's bars, latest first, by a range scan of the (symbol, date) key.
+ * bars after the date to check are read too: several checks bound their
+ * look-back window by row index from the latest bar, e.g. the 250 rows of
+ * get_price_volume_change(), and would select differently without them.
+ */
+static int __price_db_read(struct price_db *db, const char *symbol, struct stock_price *price)
+{
+	sqlite3_stmt *stmt = db->stmt_select_price;
+	int rt;
+
+	price->date_cnt = 0;
+
+	if (!price_db_symbol(db, symbol, price->sector, sizeof(price->sector)))
+		return -1;
+
+	sqlite3_bind_text(stmt, 1, symbol, -1, SQLITE_STATIC);
+
+	while ((rt = sqlite3_step(stmt)) == SQLITE_ROW) {
+		struct date_price *p;
+		struct date_price_cold *c;
+		int col = 0, j, k;
+
+		if (stock_price_reserve(price, price->date_cnt + 1) < 0) {
+			sqlite3_reset(stmt);
+			sqlite3_clear_bindings(stmt);
+			return -1;
+		}
+
+		p = &price->dateprice[price->date_cnt];
+		c = &price->cold[price->date_cnt];
+
+		memset(p, 0, sizeof(*p));
+		memset(c, 0, sizeof(*c));
+
+		p->date = sqlite3_column_int(stmt, col++);
+		c->wday = sqlite3_column_int(stmt, col++);
+		p->open = sqlite3_column_int64(stmt, col++);
+		p->high = sqlite3_column_int64(stmt, col++);
+		p->low = sqlite3_column_int64(stmt, col++);
+		p->close = sqlite3_column_int64(stmt, col++);
+		p->volume = sqlite3_column_int64(stmt, col++);
+		for (k = 0; k < indicator_nr; k++) {
+			uint32_t *value = indicator_value(&indicators[k], p);
+
+			for (j = 0; j < indicators[k].column_nr; j++)
+				value[j] = sqlite3_column_int64(stmt, col++);
+		}
+		c->typical_price = sqlite3_column_int64(stmt, col++);
+		c->raw_mf = sqlite3_column_int64(stmt, col++);
+		p->candle_color = sqlite3_column_int(stmt, col++);
+		p->candle_trend = sqlite3_column_int(stmt, col++);
+		p->sr_flag = sqlite3_column_int(stmt, col++);
+		c->height_low_spt = sqlite3_column_int64(stmt, col++);
+		c->height_2ndlow_spt = sqlite3_column_int64(stmt, col++);
+		c->height_high_rst = sqlite3_column_int64(stmt, col++);
+		c->height_2ndhigh_rst = sqlite3_column_int64(stmt, col++);
+
+		price->date_cnt += 1;
+	}
+
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	if (rt != SQLITE_DONE) {
+		anna_error("%s: sqlite3_step failed: %s\n", symbol, sqlite3_errmsg(db->sqlite));
+		return -1;
+	}
+
+	if (price->date_cnt == 0)
+		return -1;
+
+	price_db_read_state(db, symbol, price);
+
+	return 0;
+}
+
+int price_db_read(struct price_db *db, const char *symbol, struct stock_price *price)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = __price_db_read(db, symbol, price);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
+
+static int __price_db_symbols(struct price_db *db, char ***symbols)
+{
+	sqlite3_stmt *stmt;
+	char **list = NULL;
+	int nr = 0, max = 0;
+
+	if (prepare(db, "SELECT symbol FROM symbol ORDER BY symbol", &stmt) < 0)
+		return -1;
+
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		if (nr == max) {
+			char **tmp;
+
+			max = max ? max * 2 : 256;
+			tmp = realloc(list, sizeof(*list) * max);
+			if (!tmp) {
+				anna_error("realloc(%d) failed\n", max);
+				break;
+			}
+			list = tmp;
+		}
+
+		list[nr++] = strdup((const char *)sqlite3_column_text(stmt, 0));
+	}
+
+	sqlite3_finalize(stmt);
+
+	*symbols = list;
+
+	return nr;
+}
+
+/* all symbols in the database, sorted; caller frees the list */
+int price_db_symbols(struct price_db *db, char ***symbols)
+{
+	int rt;
+
+	pthread_mutex_lock(&price_db_lock);
+	rt = __price_db_symbols(db, symbols);
+	pthread_mutex_unlock(&price_db_lock);
+
+	return rt;
+}
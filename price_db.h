@@ -0,0 +1,35 @@
+#ifndef __PRICE_DB_H__
+#define __PRICE_DB_H__
+
+#include <stdint.h>
+
+struct stock_price;
+
+/*
+ * sqlite storage, ROOT_DIR/<group>.db: table 'symbol' holds every symbol's
+ * sector, table 'price' holds bars and derived statistics keyed by
+ * (symbol, date) where date is the integer yyyymmdd, table 'state' the
+ * indicator state at the latest bar (struct price_state).
+ * price_db_open() returns a handle to one group's database, several may be
+ * open at once, e.g. one for each group of a check. sqlite3.lib is built
+ * without locks (SQLITE_THREADSAFE=0), so each price_db_xxx() holds one
+ * lock of the process for its whole call: threads may call them on any
+ * handle, but only one of them is in sqlite at a time.
+ */
+
+struct price_db;
+
+struct price_db *price_db_open(const char *group);
+void price_db_close(struct price_db *db);
+int price_db_begin(struct price_db *db);
+int price_db_commit(struct price_db *db);
+int price_db_has_symbol(struct price_db *db, const char *symbol);
+int price_db_peek(struct price_db *db, const char *symbol, char *sector, int sector_sz,
+		  uint32_t *date_cnt, uint32_t *date);
+int price_db_write(struct price_db *db, const char *symbol, const char *sector, const struct stock_price *price);
+int price_db_write_rows(struct price_db *db, const char *symbol, const char *sector,
+			const struct stock_price *price, int row_nr);
+int price_db_read(struct price_db *db, const char *symbol, struct stock_price *price);
+int price_db_symbols(struct price_db *db, char ***symbols);
+
+#endif /* __PRICE_DB_H__ */
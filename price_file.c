@@ -0,0 +1,351 @@
+#include "price_file.h"
+#include "stock_price.h"
+
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* the cold rows and the state start 8-byte aligned relative to the end of the header */
+#define PRICE_FILE_ALIGN(sz)  (((sz) + 7) & ~(size_t)7)
+
+/* offset of the cold rows from the end of the header */
+static size_t price_file_cold_offset(const struct price_file_header *hdr)
+{
+	return PRICE_FILE_ALIGN((size_t)hdr->row_sz * hdr->date_cnt);
+}
+
+/* offset of the state from the end of the header */
+static size_t price_file_state_offset(const struct price_file_header *hdr)
+{
+	return PRICE_FILE_ALIGN(price_file_cold_offset(hdr) + (size_t)hdr->cold_row_sz * hdr->date_cnt);
+}
+
+static size_t price_file_body_size(const struct price_file_header *hdr)
+{
+	if (hdr->flags & PRICE_FILE_F_STATE)
+		return price_file_state_offset(hdr) + sizeof(struct price_state);
+
+	return price_file_cold_offset(hdr) + (size_t)hdr->cold_row_sz * hdr->date_cnt;
+}
+
+static int price_file_header_check(const char *fname, const struct price_file_header *hdr)
+{
+	if (hdr->version != PRICE_FILE_VERSION) {
+		anna_error("fname='%s', unsupported version=%u\n", fname, hdr->version);
+		return -1;
+	}
+
+	if (!(hdr->flags & PRICE_FILE_F_ROWS) || hdr->row_sz != sizeof(struct date_price)
+	    || hdr->cold_row_sz != sizeof(struct date_price_cold))
+	{
+		anna_error("fname='%s', unsupported flags=0x%x/row_sz=%u/cold_row_sz=%u\n",
+			   fname, hdr->flags, hdr->row_sz, hdr->cold_row_sz);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * returns 0 if price is loaded, 1 if fname is not a binary price file
+ * (i.e. a legacy text .price file), -1 on error.
+ */
+int price_file_read(const char *fname, struct stock_price *price)
+{
+	struct price_file_header hdr;
+	struct stat st;
+	size_t rows_sz;
+	char pad[8];
+	int rt = -1;
+	int fd;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	if (read_full(fd, &hdr, sizeof(hdr)) < 0 || hdr.magic != PRICE_FILE_MAGIC) {
+		rt = 1;
+		goto finish;
+	}
+
+	if (price_file_header_check(fname, &hdr) < 0)
+		goto finish;
+
+	/* the rows are sized from date_cnt, don't trust it beyond the file */
+	if (fstat(fd, &st) < 0 || st.st_size < sizeof(hdr) + price_file_body_size(&hdr)) {
+		anna_error("fname='%s' is truncated\n", fname);
+		goto finish;
+	}
+
+	if (stock_price_reserve(price, hdr.date_cnt) < 0)
+		goto finish;
+
+	/* a file without PRICE_FILE_F_STATE has no state, it's rebuilt when needed */
+	price->state.date = 0;
+
+	rows_sz = sizeof(struct date_price) * hdr.date_cnt;
+
+	if (read_full(fd, price->dateprice, rows_sz) < 0
+	    || read_full(fd, pad, price_file_cold_offset(&hdr) - rows_sz) < 0
+	    || read_full(fd, price->cold, sizeof(struct date_price_cold) * hdr.date_cnt) < 0
+	    || ((hdr.flags & PRICE_FILE_F_STATE)
+		&& (read_full(fd, pad, price_file_state_offset(&hdr) - price_file_cold_offset(&hdr)
+			      - sizeof(struct date_price_cold) * hdr.date_cnt) < 0
+		    || read_full(fd, &price->state, sizeof(price->state)) < 0)))
+	{
+		anna_error("fname='%s' is truncated\n", fname);
+		goto finish;
+	}
+
+	strlcpy(price->sector, hdr.sector, sizeof(price->sector));
+	price->date_cnt = hdr.date_cnt;
+
+	rt = 0;
+
+finish:
+	close(fd);
+
+	return rt;
+}
+
+/*
+ * map fname read-only and point price->dateprice and price->cold into the mapping,
+ * the mapping is released by stock_price_free().
+ * returns 0 if mapped, 1 if fname is not a binary price file (i.e. a legacy
+ * text .price file), -1 on error.
+ */
+int price_file_map(const char *fname, struct stock_price *price)
+{
+	const struct price_file_header *hdr;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0) {
+		anna_error("fstat(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	if (st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return 1;
+	}
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (addr == MAP_FAILED) {
+		anna_error("mmap(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	hdr = addr;
+
+	if (hdr->magic != PRICE_FILE_MAGIC) {
+		munmap(addr, st.st_size);
+		return 1;
+	}
+
+	if (price_file_header_check(fname, hdr) < 0) {
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	if (st.st_size < sizeof(*hdr) + price_file_body_size(hdr)) {
+		anna_error("fname='%s' is truncated\n", fname);
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	stock_price_free(price);
+
+	strlcpy(price->sector, hdr->sector, sizeof(price->sector));
+	price->date_cnt = hdr->date_cnt;
+	price->dateprice = (struct date_price *)(hdr + 1);
+	price->cold = (struct date_price_cold *)((char *)(hdr + 1) + price_file_cold_offset(hdr));
+	price->map_addr = addr;
+	price->map_len = st.st_size;
+	price->readonly = 1;
+
+	if (hdr->flags & PRICE_FILE_F_STATE)
+		memcpy(&price->state, (char *)(hdr + 1) + price_file_state_offset(hdr), sizeof(price->state));
+
+	return 0;
+}
+
+/*
+ * fname's sector, number of rows and latest date without reading its rows.
+ * a text file has its sector read from the %sector= line only, *date_cnt
+ * and *date are 0 then.
+ */
+int price_file_peek(const char *fname, char *sector, int sector_sz, uint32_t *date_cnt, uint32_t *date)
+{
+	struct price_file_header hdr;
+	struct date_price latest;
+	char buf[256];
+	FILE *fp;
+
+	sector[0] = 0;
+	*date_cnt = 0;
+	*date = 0;
+
+	fp = fopen(fname, "r");
+	if (!fp) {
+		anna_error("fopen(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) == 1 && hdr.magic == PRICE_FILE_MAGIC) {
+		strlcpy(sector, hdr.sector, sector_sz < sizeof(hdr.sector) ? sector_sz : sizeof(hdr.sector));
+
+		/* the rows follow the header, the latest first */
+		if (price_file_header_check(fname, &hdr) == 0 && hdr.date_cnt
+		    && fread(&latest, sizeof(latest), 1, fp) == 1)
+		{
+			*date_cnt = hdr.date_cnt;
+			*date = latest.date;
+		}
+
+		goto finish;
+	}
+
+	rewind(fp);
+
+	while (fgets(buf, sizeof(buf), fp) && (buf[0] == '#' || buf[0] == '%')) {
+		buf[strcspn(buf, "\n")] = 0;
+		if (strncmp(&buf[1], "sector=", strlen("sector=")) == 0)
+			strlcpy(sector, strchr(buf, '=') + 1, sector_sz);
+	}
+
+finish:
+	fclose(fp);
+
+	return 0;
+}
+
+int price_file_write(const char *fname, const char *sector, const struct stock_price *price)
+{
+	struct price_file_header hdr = { };
+	char tmp_fname[256];
+	const char *slash;
+	int fd;
+
+	/* write to a hidden file next to fname and rename, so readers never see a partial file */
+	slash = strrchr(fname, '/');
+	if (slash)
+		snprintf(tmp_fname, sizeof(tmp_fname), "%.*s.%s", (int)(slash - fname + 1), fname, slash + 1);
+	else
+		snprintf(tmp_fname, sizeof(tmp_fname), ".%s", fname);
+
+	hdr.magic = PRICE_FILE_MAGIC;
+	hdr.version = PRICE_FILE_VERSION;
+	hdr.date_cnt = price->date_cnt;
+	hdr.flags = PRICE_FILE_F_ROWS;
+	hdr.row_sz = sizeof(struct date_price);
+	hdr.cold_row_sz = sizeof(struct date_price_cold);
+	if (stock_price_state_valid(price))
+		hdr.flags |= PRICE_FILE_F_STATE;
+	if (sector && sector[0])
+		strlcpy(hdr.sector, sector, sizeof(hdr.sector));
+
+	fd = open(tmp_fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", tmp_fname, errno, strerror(errno));
+		return -1;
+	}
+
+	/* the alignment gaps before the cold rows and the state are left as holes */
+	if (pwrite_full(fd, &hdr, sizeof(hdr), 0) < 0
+	    || pwrite_full(fd, price->dateprice, sizeof(struct date_price) * hdr.date_cnt, sizeof(hdr)) < 0
+	    || pwrite_full(fd, price->cold, sizeof(struct date_price_cold) * hdr.date_cnt,
+			   sizeof(hdr) + price_file_cold_offset(&hdr)) < 0
+	    || ((hdr.flags & PRICE_FILE_F_STATE)
+		&& pwrite_full(fd, &price->state, sizeof(price->state),
+			       sizeof(hdr) + price_file_state_offset(&hdr)) < 0))
+	{
+		anna_error("write(%s) failed: %d(%s)\n", tmp_fname, errno, strerror(errno));
+		close(fd);
+		unlink(tmp_fname);
+		return -1;
+	}
+
+	close(fd);
+
+	if (rename(tmp_fname, fname) < 0) {
+		anna_error("rename(%s, %s) failed: %d(%s)\n", tmp_fname, fname, errno, strerror(errno));
+		unlink(tmp_fname);
+		return -1;
+	}
+
+	return 0;
+}
+
+int price_file_convert(const char *group)
+{
+	char path[128];
+	char fname[384];
+	struct stock_price price = { };
+	struct dirent *de;
+	int count = 0;
+	DIR *dir;
+
+	snprintf(path, sizeof(path), "%s/%s", ROOT_DIR, group);
+
+	dir = opendir(path);
+	if (!dir) {
+		anna_error("opendir(%s) failed: %d(%s)\n", path, errno, strerror(errno));
+		return -1;
+	}
+
+	while ((de = readdir(dir))) {
+		const char *p;
+
+		if (de->d_name[0] == '.')
+			continue;
+
+		p = strstr(de->d_name, ".price");
+		if (!p || p[strlen(".price")])
+			continue;
+
+		snprintf(fname, sizeof(fname), "%s/%s", path, de->d_name);
+
+		/* already in the current format */
+		if (price_file_map(fname, &price) == 0)
+			continue;
+
+		if (stock_price_history_from_file(fname, &price) < 0) {
+			anna_error("stock_price_history_from_file(%s) failed\n", fname);
+			continue;
+		}
+
+		if (price_file_write(fname, price.sector, &price) < 0)
+			continue;
+
+		count += 1;
+	}
+
+	closedir(dir);
+	stock_price_free(&price);
+
+	anna_info("%s%s: %d price files converted%s\n", ANSI_COLOR_YELLOW, path, count, ANSI_COLOR_RESET);
+
+	return count;
+}
@@ -0,0 +1,44 @@
+#ifndef __PRICE_FILE_H__
+#define __PRICE_FILE_H__
+
+#include <stdint.h>
+
+struct stock_price;
+
+/*
+ * binary price file: a fixed header followed by date_cnt rows in the same
+ * order as stock_price.dateprice[] (latest date first).
+ *
+ * the rows are an image of struct date_price[] followed by struct
+ * date_price_cold[] (starting 8-byte aligned), so the file can be mmap'd
+ * and handed to the checks without copying (price_file_map).
+ * with PRICE_FILE_F_STATE the rows are followed by struct price_state
+ * (8-byte aligned again), the indicator state at the latest row.
+ *
+ * values are stored in host byte order, files are not meant to be portable.
+ */
+#define PRICE_FILE_MAGIC	0x414e4e41 /* "ANNA" */
+#define PRICE_FILE_VERSION	1
+
+/* price_file_header.flags */
+#define PRICE_FILE_F_ROWS	(1<<0)
+#define PRICE_FILE_F_STATE	(1<<1)
+
+struct price_file_header
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t cold_row_sz; /* sizeof(struct date_price_cold) */
+	uint32_t date_cnt;
+	uint16_t flags; /* PRICE_FILE_F_xxx */
+	uint16_t row_sz; /* sizeof(struct date_price) if PRICE_FILE_F_ROWS */
+	char     sector[48];
+};
+
+int price_file_read(const char *fname, struct stock_price *price);
+int price_file_map(const char *fname, struct stock_price *price);
+int price_file_peek(const char *fname, char *sector, int sector_sz, uint32_t *date_cnt, uint32_t *date);
+int price_file_write(const char *fname, const char *sector, const struct stock_price *price);
+int price_file_convert(const char *group);
+
+#endif /* __PRICE_FILE_H__ */
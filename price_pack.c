@@ -0,0 +1,286 @@
+#include "price_pack.h"
+#include "stock_price.h"
+
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define PRICE_PACK_ALIGN(sz)  (((sz) + 7) & ~(size_t)7)
+
+static int symbol_cmp(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/* collect the symbols of all price files in path, sorted */
+static int list_group_symbols(const char *path, char ***symbols)
+{
+	struct dirent *de;
+	char **list = NULL;
+	int nr = 0, max = 0;
+	DIR *dir;
+
+	dir = opendir(path);
+	if (!dir) {
+		anna_error("opendir(%s) failed: %d(%s)\n", path, errno, strerror(errno));
+		return -1;
+	}
+
+	while ((de = readdir(dir))) {
+		char symbol[16];
+		char *p;
+
+		if (de->d_name[0] == '.')
+			continue;
+
+		strlcpy(symbol, de->d_name, sizeof(symbol));
+		p = strstr(symbol, ".price");
+		if (!p || p[strlen(".price")])
+			continue;
+		*p = 0;
+
+		if (nr == max) {
+			char **tmp;
+
+			max = max ? max * 2 : 256;
+			tmp = realloc(list, sizeof(*list) * max);
+			if (!tmp) {
+				anna_error("realloc(%d) failed\n", max);
+				break;
+			}
+			list = tmp;
+		}
+
+		list[nr++] = strdup(symbol);
+	}
+
+	closedir(dir);
+
+	qsort(list, nr, sizeof(*list), symbol_cmp);
+
+	*symbols = list;
+
+	return nr;
+}
+
+int price_pack_build(const char *group)
+{
+	struct price_pack_header hdr = { };
+	struct price_pack_entry *entries = NULL;
+	struct stock_price price = { };
+	char path[128], fname[256];
+	char pack_fname[128], tmp_fname[128];
+	char **symbols = NULL;
+	int symbols_nr, i, nr = 0;
+	uint64_t offset;
+	int rt = -1;
+	int fd = -1;
+
+	snprintf(path, sizeof(path), ROOT_DIR "/%s", group);
+	snprintf(pack_fname, sizeof(pack_fname), ROOT_DIR "/%s.pack", group);
+	snprintf(tmp_fname, sizeof(tmp_fname), ROOT_DIR "/.%s.pack", group);
+
+	symbols_nr = list_group_symbols(path, &symbols);
+	if (symbols_nr < 0)
+		return -1;
+
+	entries = calloc(symbols_nr ? symbols_nr : 1, sizeof(*entries));
+	if (!entries) {
+		anna_error("calloc(%d) failed\n", symbols_nr);
+		goto finish;
+	}
+
+	fd = open(tmp_fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", tmp_fname, errno, strerror(errno));
+		goto finish;
+	}
+
+	/* rows follow the directory, which is written last */
+	offset = PRICE_PACK_ALIGN(sizeof(hdr) + sizeof(*entries) * symbols_nr);
+
+	for (i = 0; i < symbols_nr; i++) {
+		struct price_pack_entry *entry = &entries[nr];
+		size_t rows_sz, cold_sz;
+
+		snprintf(fname, sizeof(fname), "%s/%s.price", path, symbols[i]);
+
+		if (stock_price_map_file(fname, &price) < 0)
+			continue;
+
+		rows_sz = sizeof(struct date_price) * price.date_cnt;
+		cold_sz = sizeof(struct date_price_cold) * price.date_cnt;
+
+		strlcpy(entry->symbol, symbols[i], sizeof(entry->symbol));
+		strlcpy(entry->sector, price.sector, sizeof(entry->sector));
+		entry->offset = offset;
+		entry->cold_offset = PRICE_PACK_ALIGN(offset + rows_sz);
+		entry->date_cnt = price.date_cnt;
+
+		if (pwrite_full(fd, price.dateprice, rows_sz, entry->offset) < 0
+		    || pwrite_full(fd, price.cold, cold_sz, entry->cold_offset) < 0)
+		{
+			anna_error("write(%s) failed: %d(%s)\n", tmp_fname, errno, strerror(errno));
+			goto finish;
+		}
+
+		offset = entry->cold_offset + cold_sz;
+		nr += 1;
+	}
+
+	hdr.magic = PRICE_PACK_MAGIC;
+	hdr.version = PRICE_PACK_VERSION;
+	hdr.row_sz = sizeof(struct date_price);
+	hdr.cold_row_sz = sizeof(struct date_price_cold);
+	hdr.symbol_nr = nr;
+
+	/* entries of skipped symbols leave a gap before the rows, that is fine */
+	if (pwrite_full(fd, &hdr, sizeof(hdr), 0) < 0
+	    || pwrite_full(fd, entries, sizeof(*entries) * nr, sizeof(hdr)) < 0)
+	{
+		anna_error("write(%s) failed: %d(%s)\n", tmp_fname, errno, strerror(errno));
+		goto finish;
+	}
+
+	close(fd);
+	fd = -1;
+
+	if (rename(tmp_fname, pack_fname) < 0) {
+		anna_error("rename(%s, %s) failed: %d(%s)\n", tmp_fname, pack_fname, errno, strerror(errno));
+		goto finish;
+	}
+
+	rt = nr;
+
+finish:
+	if (fd >= 0)
+		close(fd);
+	if (rt < 0)
+		unlink(tmp_fname);
+
+	stock_price_free(&price);
+
+	for (i = 0; i < symbols_nr; i++)
+		free(symbols[i]);
+	free(symbols);
+	free(entries);
+
+	return rt;
+}
+
+int price_pack_open(const char *group, struct price_pack *pack)
+{
+	const struct price_pack_header *hdr;
+	char fname[128];
+	struct stat st;
+	void *addr;
+	int fd, i;
+
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s.pack", group);
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size < sizeof(*hdr)) {
+		anna_error("fname='%s' is truncated\n", fname);
+		close(fd);
+		return -1;
+	}
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (addr == MAP_FAILED) {
+		anna_error("mmap(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	hdr = addr;
+
+	if (hdr->magic != PRICE_PACK_MAGIC || hdr->version != PRICE_PACK_VERSION
+	    || hdr->row_sz != sizeof(struct date_price) || hdr->cold_row_sz != sizeof(struct date_price_cold))
+	{
+		anna_error("fname='%s', unsupported version=%u/row_sz=%u/cold_row_sz=%u\n",
+			   fname, hdr->version, hdr->row_sz, hdr->cold_row_sz);
+		goto error;
+	}
+
+	pack->map_addr = addr;
+	pack->map_len = st.st_size;
+	pack->symbol_nr = hdr->symbol_nr;
+	pack->entries = (const struct price_pack_entry *)(hdr + 1);
+
+	if (sizeof(*hdr) + sizeof(pack->entries[0]) * pack->symbol_nr > st.st_size)
+		goto truncated;
+
+	for (i = 0; i < pack->symbol_nr; i++) {
+		const struct price_pack_entry *entry = &pack->entries[i];
+
+		if (entry->offset + sizeof(struct date_price) * entry->date_cnt > st.st_size
+		    || entry->cold_offset + sizeof(struct date_price_cold) * entry->date_cnt > st.st_size)
+			goto truncated;
+	}
+
+	return 0;
+
+truncated:
+	anna_error("fname='%s' is truncated\n", fname);
+error:
+	munmap(addr, st.st_size);
+	return -1;
+}
+
+void price_pack_close(struct price_pack *pack)
+{
+	if (pack->map_addr)
+		munmap(pack->map_addr, pack->map_len);
+
+	pack->map_addr = NULL;
+	pack->map_len = 0;
+	pack->symbol_nr = 0;
+	pack->entries = NULL;
+}
+
+const struct price_pack_entry *price_pack_find(const struct price_pack *pack, const char *symbol)
+{
+	int lo = 0, hi = pack->symbol_nr - 1;
+
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int cmp = strcmp(symbol, pack->entries[mid].symbol);
+
+		if (cmp == 0)
+			return &pack->entries[mid];
+
+		if (cmp < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+
+	return NULL;
+}
+
+/* point price at entry's rows, price borrows the pack's mapping and must not outlive it */
+void price_pack_view(const struct price_pack *pack, const struct price_pack_entry *entry, struct stock_price *price)
+{
+	stock_price_free(price);
+
+	strlcpy(price->sector, entry->sector, sizeof(price->sector));
+	price->date_cnt = entry->date_cnt;
+	price->dateprice = (struct date_price *)((char *)pack->map_addr + entry->offset);
+	price->cold = (struct date_price_cold *)((char *)pack->map_addr + entry->cold_offset);
+	price->readonly = 1;
+}
@@ -0,0 +1,53 @@
+#ifndef __PRICE_PACK_H__
+#define __PRICE_PACK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct stock_price;
+
+/*
+ * per-group price pack, ROOT_DIR/<group>.pack: a header, a directory of
+ * symbol_nr entries sorted by symbol, then every symbol's rows as in a
+ * price file: struct date_price[] followed by the 8-byte aligned struct
+ * date_price_cold[], latest date first.
+ * it is built from the group's price files and mmap'd as a whole by checks.
+ */
+#define PRICE_PACK_MAGIC	0x4b434150 /* "PACK" */
+#define PRICE_PACK_VERSION	1
+
+struct price_pack_header
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t row_sz; /* sizeof(struct date_price) */
+	uint32_t symbol_nr;
+	uint16_t cold_row_sz; /* sizeof(struct date_price_cold) */
+	uint16_t reserved;
+};
+
+struct price_pack_entry
+{
+	char     symbol[16];
+	char     sector[48];
+	uint64_t offset; /* of the 1st row, from the start of the pack */
+	uint64_t cold_offset; /* of the 1st cold row */
+	uint32_t date_cnt;
+	uint32_t reserved;
+};
+
+struct price_pack
+{
+	void *map_addr;
+	size_t map_len;
+	int symbol_nr;
+	const struct price_pack_entry *entries;
+};
+
+int price_pack_build(const char *group);
+int price_pack_open(const char *group, struct price_pack *pack);
+void price_pack_close(struct price_pack *pack);
+const struct price_pack_entry *price_pack_find(const struct price_pack *pack, const char *symbol);
+void price_pack_view(const struct price_pack *pack, const struct price_pack_entry *entry, struct stock_price *price);
+
+#endif /* __PRICE_PACK_H__ */
@@ -0,0 +1,786 @@
+#define _GNU_SOURCE /* struct ucred */
+
+#include "serve.h"
+#include "stock_price.h"
+#include "price_db.h"
+
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <poll.h>
+#include <signal.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/inotify.h>
+
+#define SERVE_GROUP_MAX		16
+#define SERVE_REQUEST_MAX	8192 /* the client's cwd and arguments */
+#define SERVE_ARG_MAX		256
+#define SERVE_TIMEOUT		5 /* seconds a client has to send its request */
+
+/* the histories of a group, in the order its price files were found */
+struct serve_group
+{
+	char name[16];
+	int storage;
+	int wd; /* inotify watch of the directory of its price files, -1 if it's in a database */
+	int changed; /* its database is written, what changed is read again by the next check */
+
+	int history_nr;
+	int history_max;
+	char **symbols;
+	struct stock_price **histories;
+	int *sorted; /* indexes of symbols[] in the order of the symbols, see serve_find() */
+};
+
+static struct serve_group serve_groups[SERVE_GROUP_MAX];
+static struct serve_group *serve_named[SERVE_GROUP_MAX]; /* serve_groups[] by name */
+static int serve_group_nr;
+static int inotify_fd = -1;
+static int root_wd = -1; /* ROOT_DIR, where the databases are */
+static struct serve_group **serve_watched; /* groups by the wd of their directory */
+static int serve_watched_nr;
+static int serving; /* in the daemon */
+
+/* the caches of the checks, built once for all of them */
+static int serve_warm(struct stock_price *price)
+{
+	if (stock_price_sums(price) < 0 || stock_price_ranges(price) < 0
+	    || stock_price_levels(price) < 0 || stock_price_patterns(price) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* index of symbol in g->symbols[], -1 if it's not there; *pos is where it is, or goes, in g->sorted[] */
+static int serve_find(const struct serve_group *g, const char *symbol, int *pos)
+{
+	int lo = 0, hi = g->history_nr;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int cmp = strcmp(g->symbols[g->sorted[mid]], symbol);
+
+		if (cmp == 0) {
+			*pos = mid;
+			return g->sorted[mid];
+		}
+
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	*pos = lo;
+
+	return -1;
+}
+
+/* symbol's history in g replaced by price, or added; it's dropped if price is NULL */
+static void serve_set(struct serve_group *g, const char *symbol, struct stock_price *price)
+{
+	int pos, k;
+	int i = serve_find(g, symbol, &pos);
+
+	if (i >= 0) {
+		stock_price_free(g->histories[i]);
+		free(g->histories[i]);
+
+		if (price) {
+			g->histories[i] = price;
+			return;
+		}
+
+		free(g->symbols[i]);
+
+		g->history_nr -= 1;
+		memmove(&g->symbols[i], &g->symbols[i + 1], sizeof(*g->symbols) * (g->history_nr - i));
+		memmove(&g->histories[i], &g->histories[i + 1], sizeof(*g->histories) * (g->history_nr - i));
+		memmove(&g->sorted[pos], &g->sorted[pos + 1], sizeof(*g->sorted) * (g->history_nr - pos));
+		for (k = 0; k < g->history_nr; k++) {
+			if (g->sorted[k] > i)
+				g->sorted[k] -= 1;
+		}
+		return;
+	}
+
+	if (!price)
+		return;
+
+	if (g->history_nr == g->history_max) {
+		int history_max = g->history_max ? g->history_max * 2 : 256;
+		struct stock_price **histories = NULL;
+		int *sorted = NULL;
+		char **symbols;
+
+		symbols = realloc(g->symbols, sizeof(*symbols) * history_max);
+		if (symbols) {
+			g->symbols = symbols;
+			histories = realloc(g->histories, sizeof(*histories) * history_max);
+		}
+		if (histories) {
+			g->histories = histories;
+			sorted = realloc(g->sorted, sizeof(*sorted) * history_max);
+		}
+
+		if (!sorted) {
+			anna_error("realloc(%d) failed\n", history_max);
+			stock_price_free(price);
+			free(price);
+			return;
+		}
+
+		g->sorted = sorted;
+		g->history_max = history_max;
+	}
+
+	/* kept in the order it's found, indexed in the order of the symbols */
+	g->symbols[g->history_nr] = strdup(symbol);
+	g->histories[g->history_nr] = price;
+	memmove(&g->sorted[pos + 1], &g->sorted[pos], sizeof(*g->sorted) * (g->history_nr - pos));
+	g->sorted[pos] = g->history_nr;
+	g->history_nr += 1;
+}
+
+static void serve_drop(struct serve_group *g)
+{
+	int i;
+
+	for (i = 0; i < g->history_nr; i++) {
+		stock_price_free(g->histories[i]);
+		free(g->histories[i]);
+		free(g->symbols[i]);
+	}
+
+	g->history_nr = 0;
+}
+
+/* read the price file name of g again, drop it if it's gone */
+static void serve_read_file(struct serve_group *g, const char *name)
+{
+	struct stock_price *price;
+	char fname[256], symbol[16], *p;
+
+	/* written to a temporary file first, see price_file_write() */
+	if (name[0] == '.')
+		return;
+
+	strlcpy(symbol, name, sizeof(symbol));
+	p = strstr(symbol, ".price");
+	if (p)
+		*p = 0;
+
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s/%s", g->name, name);
+
+	if (access(fname, F_OK) < 0) {
+		serve_set(g, symbol, NULL);
+		return;
+	}
+
+	price = calloc(1, sizeof(*price));
+	if (!price) {
+		anna_error("calloc(%zu) failed\n", sizeof(*price));
+		return;
+	}
+
+	if (stock_price_history_from_file(fname, price) < 0 || serve_warm(price) < 0) {
+		anna_error("%s is not read\n", fname);
+		stock_price_free(price);
+		free(price);
+		return;
+	}
+
+	serve_set(g, symbol, price);
+}
+
+static int serve_read_dir(struct serve_group *g)
+{
+	struct dirent *de;
+	char path[128];
+	DIR *dir;
+
+	snprintf(path, sizeof(path), ROOT_DIR "/%s", g->name);
+
+	dir = opendir(path);
+	if (!dir) {
+		anna_error("opendir(%s) failed: %d(%s)\n", path, errno, strerror(errno));
+		return -1;
+	}
+
+	while ((de = readdir(dir)))
+		serve_read_file(g, de->d_name);
+
+	closedir(dir);
+
+	return 0;
+}
+
+static int serve_symbol_cmp(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/* read the symbols of g's database that changed since they were read, drop those gone from it */
+static int serve_read_db(struct serve_group *g)
+{
+	struct price_db *db;
+	char **symbols = NULL;
+	char sector[48];
+	uint32_t date_cnt, date;
+	int symbol_nr, i, h, pos;
+
+	g->changed = 0;
+
+	db = price_db_open(g->name);
+	if (!db)
+		return -1;
+
+	/* sorted, as strcmp() does */
+	symbol_nr = price_db_symbols(db, &symbols);
+	if (symbol_nr < 0) {
+		price_db_close(db);
+		return -1;
+	}
+
+	for (i = g->history_nr - 1; i >= 0; i--) {
+		if (!bsearch(&g->symbols[i], symbols, symbol_nr, sizeof(*symbols), serve_symbol_cmp))
+			serve_set(g, g->symbols[i], NULL);
+	}
+
+	for (i = 0; i < symbol_nr; i++) {
+		const struct stock_price *old;
+		struct stock_price *price;
+
+		h = serve_find(g, symbols[i], &pos);
+		old = h >= 0 ? g->histories[h] : NULL;
+
+		/* unchanged if it has as many bars up to the same latest date, in the same sector */
+		if (old && old->date_cnt
+		    && price_db_peek(db, symbols[i], sector, sizeof(sector), &date_cnt, &date) == 0
+		    && date_cnt == old->date_cnt && date == old->dateprice[0].date && strcmp(sector, old->sector) == 0)
+		{
+			free(symbols[i]);
+			continue;
+		}
+
+		price = calloc(1, sizeof(*price));
+		if (!price)
+			anna_error("calloc(%zu) failed\n", sizeof(*price));
+		else if (price_db_read(db, symbols[i], price) < 0 || serve_warm(price) < 0) {
+			stock_price_free(price);
+			free(price);
+			serve_set(g, symbols[i], NULL);
+		}
+		else
+			serve_set(g, symbols[i], price);
+
+		free(symbols[i]);
+	}
+
+	free(symbols);
+	price_db_close(db);
+
+	return 0;
+}
+
+static int serve_name_cmp(const void *a, const void *b)
+{
+	return strcmp((const char *)a, (*(struct serve_group **)b)->name);
+}
+
+/* the group served as name, NULL if there is none */
+static struct serve_group *serve_group_find(const char *name)
+{
+	struct serve_group **g = bsearch(name, serve_named, serve_group_nr, sizeof(*serve_named), serve_name_cmp);
+
+	return g ? *g : NULL;
+}
+
+/* watch the directory of g's price files, by the wd of its events */
+static int serve_watch(struct serve_group *g, const char *path)
+{
+	g->wd = inotify_add_watch(inotify_fd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+	if (g->wd < 0) {
+		anna_error("inotify_add_watch(%s) failed: %d(%s)\n", path, errno, strerror(errno));
+		return -1;
+	}
+
+	/* wds are small numbers, given in turn */
+	if (g->wd >= serve_watched_nr) {
+		struct serve_group **watched = realloc(serve_watched, sizeof(*watched) * (g->wd + 1));
+
+		if (!watched) {
+			anna_error("realloc(%zu) failed\n", sizeof(*watched) * (g->wd + 1));
+			inotify_rm_watch(inotify_fd, g->wd);
+			g->wd = -1;
+			return -1;
+		}
+
+		memset(&watched[serve_watched_nr], 0, sizeof(*watched) * (g->wd + 1 - serve_watched_nr));
+		serve_watched = watched;
+		serve_watched_nr = g->wd + 1;
+	}
+
+	serve_watched[g->wd] = g;
+
+	return 0;
+}
+
+/* keep the histories of group, read as storage says, in memory */
+int serve_load(const char *group, int storage)
+{
+	struct serve_group *g;
+	char path[128];
+	int i;
+
+	if (serve_group_nr == SERVE_GROUP_MAX) {
+		anna_error("up to %d groups are served\n", SERVE_GROUP_MAX);
+		return -1;
+	}
+
+	if (inotify_fd < 0) {
+		inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify_fd < 0) {
+			anna_error("inotify_init1 failed: %d(%s)\n", errno, strerror(errno));
+			return -1;
+		}
+
+		/* the databases are written in place, or to their -wal file */
+		root_wd = inotify_add_watch(inotify_fd, ROOT_DIR, IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (root_wd < 0)
+			anna_error("inotify_add_watch(%s) failed: %d(%s)\n", ROOT_DIR, errno, strerror(errno));
+	}
+
+	g = &serve_groups[serve_group_nr];
+	memset(g, 0, sizeof(*g));
+	strlcpy(g->name, group, sizeof(g->name));
+	g->storage = storage;
+	g->wd = -1;
+
+	if (serve_group_find(g->name)) {
+		anna_error("group %s is served already\n", g->name);
+		return -1;
+	}
+
+	for (i = serve_group_nr; i > 0 && strcmp(serve_named[i - 1]->name, g->name) > 0; i--)
+		serve_named[i] = serve_named[i - 1];
+	serve_named[i] = g;
+	serve_group_nr += 1;
+
+	if (storage == PRICE_STORAGE_SQLITE)
+		return serve_read_db(g);
+
+	/* the pack is built from the price files, they are kept instead. watched before they are read */
+	snprintf(path, sizeof(path), ROOT_DIR "/%s", group);
+	serve_watch(g, path);
+
+	return serve_read_dir(g);
+}
+
+/* name in ROOT_DIR is written: <group>.db, or its <group>.db-wal */
+static void serve_db_event(const char *name)
+{
+	struct serve_group *g;
+	char group[32];
+	const char *p;
+
+	p = strstr(name, ".db");
+	if (!p || (strcmp(p, ".db") && strcmp(p, ".db-wal")) || p - name >= sizeof(group))
+		return;
+
+	memcpy(group, name, p - name);
+	group[p - name] = 0;
+
+	g = serve_group_find(group);
+	if (g && g->wd < 0)
+		g->changed = 1;
+}
+
+/* read again what is written since */
+static void serve_events(void)
+{
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t len;
+	int i;
+
+	if (inotify_fd < 0)
+		return;
+
+	while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+		char *p = buf;
+
+		while (p < buf + len) {
+			const struct inotify_event *ev = (const struct inotify_event *)p;
+
+			p += sizeof(*ev) + ev->len;
+
+			/* events are lost, read everything again */
+			if (ev->mask & IN_Q_OVERFLOW) {
+				for (i = 0; i < serve_group_nr; i++) {
+					if (serve_groups[i].wd < 0)
+						serve_groups[i].changed = 1;
+					else {
+						serve_drop(&serve_groups[i]);
+						serve_read_dir(&serve_groups[i]);
+					}
+				}
+				continue;
+			}
+
+			if (!ev->len)
+				continue;
+
+			if (ev->wd == root_wd)
+				serve_db_event(ev->name);
+			else if (ev->wd >= 0 && ev->wd < serve_watched_nr && serve_watched[ev->wd])
+				serve_read_file(serve_watched[ev->wd], ev->name);
+		}
+	}
+}
+
+/* the histories in memory of group, if it's checked by the daemon */
+void serve_histories(struct check_group *group)
+{
+	struct serve_group *g;
+
+	if (!serving)
+		return;
+
+	g = serve_group_find(group->name);
+	if (!g)
+		return;
+
+	if (g->changed)
+		serve_read_db(g);
+
+	group->history_nr = g->history_nr;
+	group->history_symbols = g->symbols;
+	group->histories = g->histories;
+}
+
+/*
+ * run argv with fds[] as stdout and stderr. the daemon exits if its own
+ * can't be restored, rather than go on printing to the client's.
+ */
+static int serve_client_run(const int fds[2], int (*run)(int argc, const char **argv), int argc, const char **argv)
+{
+	int saved_out, saved_err;
+	int rt = -1;
+
+	fflush(stdout);
+	fflush(stderr);
+
+	saved_out = dup(STDOUT_FILENO);
+	if (saved_out < 0) {
+		anna_error("dup failed: %d(%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	saved_err = dup(STDERR_FILENO);
+	if (saved_err < 0) {
+		anna_error("dup failed: %d(%s)\n", errno, strerror(errno));
+		close(saved_out);
+		return -1;
+	}
+
+	if (dup2(fds[0], STDOUT_FILENO) < 0 || dup2(fds[1], STDERR_FILENO) < 0)
+		anna_error("dup2 failed: %d(%s)\n", errno, strerror(errno));
+	else
+		rt = run(argc, argv);
+
+	fflush(stdout);
+	fflush(stderr);
+
+	if (dup2(saved_out, STDOUT_FILENO) < 0 || dup2(saved_err, STDERR_FILENO) < 0) {
+		anna_error("dup2 failed: %d(%s), the daemon exits\n", errno, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	close(saved_out);
+	close(saved_err);
+
+	return rt;
+}
+
+/*
+ * run the request of the client connected by fd: its cwd then its
+ * arguments, with its stdout and stderr. a byte is sent back when it's
+ * done. a client of another user, or one that doesn't send its request
+ * in SERVE_TIMEOUT seconds, is dropped.
+ */
+static void serve_client(int fd, int (*run)(int argc, const char **argv))
+{
+	union {
+		char buf[CMSG_SPACE(sizeof(int) * 2)];
+		struct cmsghdr align;
+	} ctl;
+	char buf[SERVE_REQUEST_MAX + 1], cwd[PATH_MAX];
+	const char *argv[SERVE_ARG_MAX + 1];
+	struct iovec iov;
+	struct msghdr msg = { };
+	struct cmsghdr *cmsg;
+	struct timeval timeout = { .tv_sec = SERVE_TIMEOUT };
+	struct ucred cred;
+	socklen_t cred_len = sizeof(cred);
+	int fds[2] = { -1, -1 };
+	uint32_t len;
+	ssize_t n;
+	int argc = 0;
+	char *p;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0 || cred.uid != getuid()) {
+		anna_error("a client not of uid %u is refused\n", getuid());
+		goto finish;
+	}
+
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+		anna_error("setsockopt(SO_RCVTIMEO) failed: %d(%s)\n", errno, strerror(errno));
+		goto finish;
+	}
+
+	iov.iov_base = &len;
+	iov.iov_len = sizeof(len);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl.buf;
+	msg.msg_controllen = sizeof(ctl.buf);
+
+	n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		anna_error("no request in %d seconds\n", SERVE_TIMEOUT);
+	if (n <= 0 || (n < sizeof(len) && read_full(fd, (char *)&len + n, sizeof(len) - n) < 0))
+		goto finish;
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+	    && cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+		memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+	if (fds[0] < 0 || fds[1] < 0 || len > SERVE_REQUEST_MAX || read_full(fd, buf, len) < 0) {
+		anna_error("bad request\n");
+		goto finish;
+	}
+
+	buf[len] = 0;
+
+	for (p = buf + strlen(buf) + 1; p < buf + len && argc < SERVE_ARG_MAX; p += strlen(p) + 1)
+		argv[argc++] = p;
+	argv[argc] = NULL;
+
+	if (!getcwd(cwd, sizeof(cwd)) || chdir(buf) < 0) {
+		anna_error("chdir(%s) failed: %d(%s)\n", buf, errno, strerror(errno));
+		goto finish;
+	}
+
+	/* the files written since the last event are read first */
+	serve_events();
+
+	serve_client_run(fds, run, argc, argv);
+
+	if (chdir(cwd) < 0)
+		anna_error("chdir(%s) failed: %d(%s)\n", cwd, errno, strerror(errno));
+
+	write_full(fd, "", 1);
+
+finish:
+	if (fds[0] >= 0)
+		close(fds[0]);
+	if (fds[1] >= 0)
+		close(fds[1]);
+	close(fd);
+}
+
+/*
+ * 1 if a daemon answers on SERVE_SOCKET, 0 if none does: a socket left by
+ * one that's gone is removed then. -1 if it can't be told.
+ */
+int serve_running(void)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	int fd, rt;
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		anna_error("socket failed: %d(%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	strlcpy(addr.sun_path, SERVE_SOCKET, sizeof(addr.sun_path));
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+		rt = 1;
+	else if (errno == ENOENT)
+		rt = 0;
+	else if (errno == ECONNREFUSED)
+		rt = unlink(SERVE_SOCKET) < 0 && errno != ENOENT ? -1 : 0;
+	else {
+		anna_error("connect(%s) failed: %d(%s)\n", SERVE_SOCKET, errno, strerror(errno));
+		rt = -1;
+	}
+
+	close(fd);
+
+	return rt;
+}
+
+/* answer the requests of serve_request() until killed */
+int serve_loop(int (*run)(int argc, const char **argv))
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct pollfd pfd[2];
+	mode_t mask;
+	int listen_fd;
+	int i, rt, history_nr = 0;
+
+	/* a client gone while its check is printed */
+	signal(SIGPIPE, SIG_IGN);
+
+	rt = serve_running();
+	if (rt) {
+		if (rt > 0)
+			anna_error("a daemon is serving on %s already\n", SERVE_SOCKET);
+		return -1;
+	}
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0) {
+		anna_error("socket failed: %d(%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	strlcpy(addr.sun_path, SERVE_SOCKET, sizeof(addr.sun_path));
+
+	/* for the user only, from the start */
+	mask = umask(0177);
+	rt = bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(mask);
+
+	if (rt < 0 || chmod(SERVE_SOCKET, 0600) < 0 || listen(listen_fd, 16) < 0) {
+		anna_error("bind(%s) failed: %d(%s)\n", SERVE_SOCKET, errno, strerror(errno));
+		close(listen_fd);
+		return -1;
+	}
+
+	serving = 1;
+
+	for (i = 0; i < serve_group_nr; i++)
+		history_nr += serve_groups[i].history_nr;
+
+	anna_info("%s%d histories of %d groups are served on %s%s\n", ANSI_COLOR_YELLOW, history_nr, serve_group_nr,
+		  SERVE_SOCKET, ANSI_COLOR_RESET);
+
+	for (;;) {
+		pfd[0].fd = inotify_fd;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = listen_fd;
+		pfd[1].events = POLLIN;
+
+		if (poll(pfd, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			anna_error("poll failed: %d(%s)\n", errno, strerror(errno));
+			break;
+		}
+
+		if (pfd[0].revents & POLLIN)
+			serve_events();
+
+		if (pfd[1].revents & POLLIN) {
+			int fd = accept(listen_fd, NULL, NULL);
+
+			if (fd >= 0)
+				serve_client(fd, run);
+		}
+	}
+
+	close(listen_fd);
+	unlink(SERVE_SOCKET);
+
+	return -1;
+}
+
+/*
+ * send argv to 'anna serve' with stdout and stderr, its output is printed
+ * to, and wait until it's run. -1 if no daemon is running.
+ */
+int serve_request(int argc, const char **argv)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	union {
+		char buf[CMSG_SPACE(sizeof(int) * 2)];
+		struct cmsghdr align;
+	} ctl;
+	int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+	char buf[SERVE_REQUEST_MAX];
+	struct iovec iov[2];
+	struct msghdr msg = { };
+	struct cmsghdr *cmsg;
+	uint32_t len;
+	char done;
+	int fd, i;
+
+	if (!getcwd(buf, sizeof(buf)))
+		return -1;
+
+	len = strlen(buf) + 1;
+
+	for (i = 0; i < argc; i++) {
+		if (len + strlen(argv[i]) + 1 > sizeof(buf))
+			return -1;
+
+		strcpy(buf + len, argv[i]);
+		len += strlen(argv[i]) + 1;
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	strlcpy(addr.sun_path, SERVE_SOCKET, sizeof(addr.sun_path));
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	iov[0].iov_base = &len;
+	iov[0].iov_len = sizeof(len);
+	iov[1].iov_base = buf;
+	iov[1].iov_len = len;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+	msg.msg_control = ctl.buf;
+	msg.msg_controllen = sizeof(ctl.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	fflush(stdout);
+	fflush(stderr);
+
+	if (sendmsg(fd, &msg, 0) != sizeof(len) + len) {
+		close(fd);
+		return -1;
+	}
+
+	if (read_full(fd, &done, 1) < 0)
+		anna_error("%s is closed before the check is done\n", SERVE_SOCKET);
+
+	close(fd);
+
+	return 0;
+}
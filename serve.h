@@ -0,0 +1,26 @@
+#ifndef __SERVE_H__
+#define __SERVE_H__
+
+#include "util.h"
+
+struct check_group;
+
+/*
+ * 'anna serve': a daemon keeping every group's histories in memory, with
+ * the caches of the checks built. the checks of 'anna' are sent to it
+ * over SERVE_SOCKET, along with the client's stdout and stderr they are
+ * printed to, and run on the histories in memory. the group's price files
+ * are watched by inotify and read again as they are written, the symbols
+ * changed in its database before the next check. a check is run by 'anna'
+ * itself if no daemon is running. the socket is the user's only, a
+ * second daemon refuses to start while one answers on it.
+ */
+#define SERVE_SOCKET	ROOT_DIR "/anna.sock"
+
+int serve_running(void);
+int serve_load(const char *group, int storage);
+int serve_loop(int (*run)(int argc, const char **argv));
+int serve_request(int argc, const char **argv);
+void serve_histories(struct check_group *group);
+
+#endif /* __SERVE_H__ */
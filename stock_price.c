@@ -2,6 +2,11 @@
 
 #include "util.h"
 #include "fetch_price.h"
+#include "price_file.h"
+#include "price_pack.h"
+#include "price_db.h"
+#include "csv.h"
+#include "indicator.h"
 
 #include <stdio.h>
 #include <errno.h>
@@ -11,241 +16,246 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*
+ * a scan as seen by its symbol_check_xxx( ): the parameters, shared by the
+ * threads checking its symbols, then the output and count of the thread's
+ * symbol. nothing else is shared, scans run independently of each other.
+ */
+struct check_ctx
+{
+	const struct check_params *params;
+	int sma2check; /* days of the sma to check, 0 if none */
+	int weeks2check;
+
+	FILE *out; /* stdout, or the output of the symbol, see check_worker( ) */
+	int selected_nr;
+	char change_str[256]; /* see get_price_volume_change( ) */
+};
 
-static int sma2check = -1;
-static int weeks2check = 0;
-static int selected_symbol_nr = 0;
+#define check_info(ctx, fmt, args...) \
+	do { \
+		fprintf((ctx)->out, fmt, ##args); \
+		fflush((ctx)->out); \
+	} while (0)
 
 const char *candle_color[CANDLE_COLOR_NR] = { "doji", "green", "red" };
 const char *candle_trend[CANDLE_TREND_NR] = { "doji", "bull", "bear" };
 
-static void parse_price(char *price_str, uint32_t *price)
+/* the sma of ctx->sma2check days at row, which points into price_history->dateprice[] */
+static uint32_t sma2check_at(const struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *row)
 {
-	char *dot = strchr(price_str, '.');
+	return stock_price_sma(price_history, row - price_history->dateprice, ctx->sma2check);
+}
 
-	if (!dot) {
-		*price = atoi(price_str) * 1000;
-	}
-	else {
-		int i;
-		char saved_char = *dot;
-		*dot = 0;
+static int price_state_valid_at(const struct stock_price *price, int idx)
+{
+	return idx < price->date_cnt
+	       && price->state.date && price->state.date == price->dateprice[idx].date
+	       && price->state.row_nr == price->date_cnt - idx;
+}
 
-		*price = atoi(price_str) * 1000;
+/* price->state is at the latest row */
+int stock_price_state_valid(const struct stock_price *price)
+{
+	return price_state_valid_at(price, 0);
+}
 
-		*dot = saved_char;
+/*
+ * candle color and trend of nr rows, without branches so a column of
+ * them runs at the same speed whatever the candles are. the trend is bull
+ * if close is nearer to the high than to the low, bear if nearer to the
+ * low, doji if it's in the middle, or if high is low and close is less
+ * than 1% of open from that middle.
+ */
+static void calculate_candle_stats(struct date_price *rows, int nr)
+{
+	int i;
 
-		for (i = 1; *(dot + i) && isdigit(*(dot + i)) && i <= 3; i++)
-			*price += (*(dot + i) - '0') * (i == 1 ? 100 : ((i == 2) ? 10 : 1));
+	for (i = 0; i < nr; i++) {
+		struct date_price *cur = &rows[i];
+		uint32_t up_price = cur->close - cur->low;
+		uint32_t down_price = cur->high - cur->close;
+		uint64_t diff_price = up_price > down_price ? up_price - down_price : down_price - up_price;
+		int doji = (cur->high == cur->low) & (diff_price * 100 < cur->open);
 
-		if (i == 4 && *(dot + i) && isdigit(*(dot + i)) && *(dot + i) >= '5')
-			*price += 1;
+		cur->candle_color = (cur->close > cur->open) * CANDLE_COLOR_GREEN
+				    | (cur->close < cur->open) * CANDLE_COLOR_RED;
+		cur->candle_trend = ((up_price > down_price) * CANDLE_TREND_BULL
+				     | (up_price < down_price) * CANDLE_TREND_BEAR) * !doji;
 	}
 }
 
-static int sma_days[SMA_NR] = { 10, 20, 30, 50, 60, 100, 120, 200 };
-static int vma_days[VMA_NR] = { 10, 20, 60 };
+#define get_2ndlow(dateprice) \
+	((dateprice)->candle_color == CANDLE_COLOR_GREEN ? (dateprice)->open : (dateprice)->close)
+
+#define get_2ndhigh(dateprice) \
+	((dateprice)->candle_color == CANDLE_COLOR_GREEN ? (dateprice)->close : (dateprice)->open)
+
+static const int min_sr_candle_nr = 5;
+static const int max_sr_candle_nr = 20;
+static const int diff_margin_percent = 4;
 
-static void calculate_moving_avg(int is_price, struct stock_price *price, int cur_idx, int ma_days, uint64_t *sum, uint32_t *ma)
+enum
 {
-	int cnt = price->date_cnt - cur_idx;
-	struct date_price *cur = &price->dateprice[cur_idx];
+	SR_LOW,
+	SR_2ndLOW,
+	SR_HIGH,
+	SR_2ndHIGH,
 
-	(*sum) += is_price ? cur->close : cur->volume;
+	SR_NR
+};
 
-	if (cnt >= ma_days) {
-		if (cnt > ma_days)
-			(*sum) -= is_price ? (cur + ma_days)->close : (cur + ma_days)->volume;
-		*ma = (*sum) / ma_days;
-	}
-}
+static const char *sr_name[SR_NR] = { "is_low_spt", "is_2ndlow_spt", "is_high_rst", "is_2ndhigh_rst" };
 
-static void calculate_sma(struct stock_price *price, int cur_idx,
-			  int sma_type, uint64_t *price_sum, struct date_price *cur)
+/*
+ * rows on each side of a row, up to max_sr_candle_nr, before the first one
+ * breaking its support (a lower low/2ndlow) or resistance (a higher
+ * high/2ndhigh). left is older rows, right newer rows.
+ */
+struct sr_span
 {
-	if (sma_type < 0 || sma_type >= SMA_NR) {
-		anna_error("invalid sma_type=%d\n", sma_type);
-		return;
-	}
-
-	calculate_moving_avg(1, price, cur_idx, sma_days[sma_type], price_sum, &cur->sma[sma_type]);
-}
+	uint8_t left[SR_NR];
+	uint8_t right[SR_NR];
+};
 
-static void calculate_vma(struct stock_price *price, int cur_idx,
-			  int vma_type, uint64_t *volume_sum, struct date_price *cur)
+static uint32_t sr_value(const struct date_price *p, int sr)
 {
-	if (vma_type < 0 || vma_type >= VMA_NR) {
-		anna_error("invalid vma_type=%d\n", vma_type);
-		return;
+	switch (sr) {
+	case SR_LOW:
+		return p->low;
+	case SR_2ndLOW:
+		return get_2ndlow(p);
+	case SR_HIGH:
+		return p->high;
+	default:
+		return get_2ndhigh(p);
 	}
-
-	calculate_moving_avg(0, price, cur_idx, vma_days[vma_type], volume_sum, &cur->vma[vma_type]);
 }
 
-static void calculate_mfi(struct stock_price *price, int cur_idx, struct date_price *cur,
-			  uint64_t *positive_raw_mf, uint64_t *negative_raw_mf)
+/* if a row with val breaks the support/resistance of a row with cur_val */
+static int sr_breaks(int sr, uint32_t val, uint32_t cur_val)
 {
-	struct date_price *prev;
-	int cnt = price->date_cnt - cur_idx;
+	return sr < SR_HIGH ? val < cur_val : val > cur_val;
+}
 
-	cur->typical_price = (cur->high + cur->low + cur->close) / 3;
-	cur->raw_mf = (uint64_t)cur->typical_price * cur->volume;
+/*
+ * spans are found while rows stream in from the oldest one, with a
+ * monotonic stack per side: a row pops every older row it shadows, those
+ * are never the first breaking row on the left of any newer row, and every
+ * older row it breaks, it's the first breaking row on their right. spans
+ * are capped at max_sr_candle_nr, so only that many rows (and one more)
+ * matter on either side; older ones are dropped from the bottom of the
+ * stacks. a row's left span is final when it streams in, its right span
+ * once max_sr_candle_nr newer rows did (or the latest row).
+ */
+#define SR_STACK_SZ	32 /* > max_sr_candle_nr + 1, power of 2 */
+#define SR_SPAN_SZ	256 /* > stat_tile_rows + max_sr_candle_nr, power of 2 */
 
-	/* add current date's raw money flow */
-	if (cnt == 1)
-		*positive_raw_mf += cur->raw_mf;
-	else {
-		prev = cur + 1;
-		if (cur->typical_price >= prev->typical_price)
-			*positive_raw_mf += cur->raw_mf;
-		else
-			*negative_raw_mf += cur->raw_mf;
-	}
+struct sr_stack
+{
+	int row[SR_STACK_SZ];
+	unsigned int bottom, top;
+};
 
-	if (cnt < 14)
-		return;
+struct sr_tracker
+{
+	const struct stock_price *price;
+	struct sr_stack left[SR_NR], right[SR_NR];
+	struct sr_span span[SR_SPAN_SZ]; /* of row i at i % SR_SPAN_SZ */
+};
 
-	/* delete 15days-ago's money flow */
-	if (cnt > 14) {
-		prev = cur + 14;
-		if (cnt == 15 || prev->typical_price >= (prev+1)->typical_price)
-			*positive_raw_mf -= prev->raw_mf;
-		else
-			*negative_raw_mf -= prev->raw_mf;
-	}
+#define sr_stack_empty(stack)	((stack)->top == (stack)->bottom)
+#define sr_stack_top(stack)	((stack)->row[((stack)->top - 1) % SR_STACK_SZ])
+#define sr_stack_bottom(stack)	((stack)->row[(stack)->bottom % SR_STACK_SZ])
+#define sr_stack_push(stack, i)	((stack)->row[(stack)->top++ % SR_STACK_SZ] = (i))
 
-	cur->mfi = 10000 - 1000000 / (100 + (*positive_raw_mf * 100 / (*negative_raw_mf ? *negative_raw_mf : 100)));
+static void sr_tracker_init(struct sr_tracker *tracker, const struct stock_price *price)
+{
+	memset(tracker, 0, sizeof(*tracker));
+	tracker->price = price;
 }
 
-static void calculate_candle_stats(struct date_price *cur)
+static const struct sr_span *sr_tracker_span(const struct sr_tracker *tracker, int i)
 {
-	/* calculate candle color */
-	if (cur->close > cur->open)
-		cur->candle_color = CANDLE_COLOR_GREEN;
-	else if (cur->close < cur->open)
-		cur->candle_color = CANDLE_COLOR_RED;
-	else
-		cur->candle_color = CANDLE_COLOR_DOJI;
+	return &tracker->span[i % SR_SPAN_SZ];
+}
 
-	/* calculate candle trend */
-	uint64_t diff_price = 0;
-	uint64_t up_price = cur->close - cur->low;
-	uint64_t down_price = cur->high - cur->close;
-	if (up_price > down_price) {
-		cur->candle_trend = CANDLE_TREND_BULL;
-		diff_price = up_price - down_price;
-	}
-	else if (up_price < down_price) {
-		cur->candle_trend = CANDLE_TREND_BEAR;
-		diff_price = down_price - up_price;
-	}
+/* row i streams in, the one after the previous row */
+static void sr_tracker_push(struct sr_tracker *tracker, int i)
+{
+	const struct date_price *dateprice = tracker->price->dateprice;
+	struct sr_span *span = &tracker->span[i % SR_SPAN_SZ];
+	int sr;
 
-	if (cur->open && (diff_price * 100 / cur->open) < 1) {
-		if (cur->high - cur->low == 0)
-			cur->candle_trend = CANDLE_TREND_DOJI;
-		else if (up_price == 0)
-			cur->candle_trend = CANDLE_TREND_BEAR;
-		else if (down_price == 0)
-			cur->candle_trend = CANDLE_TREND_BULL;
-		else if (up_price > down_price && up_price * 100 / (cur->high - cur->low) >= 60)
-			cur->candle_trend = CANDLE_TREND_BULL;
-		else if (up_price < down_price && down_price * 100 / (cur->high - cur->low) >= 60)
-			cur->candle_trend = CANDLE_TREND_BEAR;
-	}
-}
+	for (sr = 0; sr < SR_NR; sr++) {
+		struct sr_stack *left = &tracker->left[sr], *right = &tracker->right[sr];
+		uint32_t val = sr_value(&dateprice[i], sr);
+		int side_nr = tracker->price->date_cnt - 1 - i;
 
-#define get_2ndlow(dateprice) \
-	((dateprice)->candle_color == CANDLE_COLOR_GREEN ? (dateprice)->open : (dateprice)->close)
+		/* rows more than max_sr_candle_nr older can't shorten a span */
+		while (!sr_stack_empty(left) && sr_stack_bottom(left) > i + max_sr_candle_nr)
+			left->bottom++;
 
-#define get_2ndhigh(dateprice) \
-	((dateprice)->candle_color == CANDLE_COLOR_GREEN ? (dateprice)->close : (dateprice)->open)
+		while (!sr_stack_empty(left) && !sr_breaks(sr, sr_value(&dateprice[sr_stack_top(left)], sr), val))
+			left->top--;
 
-static const int min_sr_candle_nr = 5;
-static const int max_sr_candle_nr = 20;
-static const int diff_margin_percent = 4;
+		if (!sr_stack_empty(left) && sr_stack_top(left) - i - 1 < side_nr)
+			side_nr = sr_stack_top(left) - i - 1;
 
-static void calculate_one_side_sr(struct date_price *cur, struct date_price *test_price,
-				int *is_low_spt, int *stop_low, int *candle_low_nr, uint64_t *max_low_diff,
-				int *is_2ndlow_spt, int *stop_2ndlow, int *candle_2ndlow_nr, uint64_t *max_2ndlow_diff,
-				int *is_high_rst, int *stop_high, int *candle_high_nr, uint64_t *max_high_diff,
-				int *is_2ndhigh_rst, int *stop_2ndhigh, int *candle_2ndhigh_nr, uint64_t *max_2ndhigh_diff)
-{
-	uint64_t cur_2ndlow = get_2ndlow(cur);
-	uint64_t cur_2ndhigh = get_2ndhigh(cur);
-	uint64_t tp_2ndlow = get_2ndlow(test_price);
-	uint64_t tp_2ndhigh = get_2ndhigh(test_price);
-
-	if (!(*stop_low) && *is_low_spt) {
-		if (test_price->low < cur->low) {
-			if (*candle_low_nr < min_sr_candle_nr - 1)
-				*is_low_spt = 0;
-			else
-				*stop_low = 1;
-		}
-		else if (test_price->high < cur->low) {
-			anna_error("is_low_spt algo error: cur_date=%s, test_date=%s\n", cur->date, test_price->date);
-			(*is_low_spt) = 0;
-		}
-		else {
-			if (test_price->high - cur->low > *max_low_diff)
-				*max_low_diff = test_price->high - cur->low;
-			(*candle_low_nr) += 1;
-		}
-	}
+		span->left[sr] = side_nr < max_sr_candle_nr ? side_nr : max_sr_candle_nr;
+		sr_stack_push(left, i);
 
-	if (!(*stop_2ndlow) && *is_2ndlow_spt) {
-		if (tp_2ndlow < cur_2ndlow) {
-			if (*candle_2ndlow_nr < min_sr_candle_nr - 1)
-				*is_2ndlow_spt = 0;
-			else
-				*stop_2ndlow = 1;
-		}
-		else if (test_price->high < cur_2ndlow) {
-			anna_error("is_2ndlow_spt algo error: cur_date=%s, test_date=%s\n", cur->date, test_price->date);
-			(*is_2ndlow_spt) = 0;
-		}
-		else {
-			if (test_price->high - cur_2ndlow > *max_2ndlow_diff)
-				*max_2ndlow_diff = test_price->high - cur_2ndlow;
-			(*candle_2ndlow_nr) += 1;
-		}
-	}
+		/* and their right spans are final, max_sr_candle_nr */
+		while (!sr_stack_empty(right) && sr_stack_bottom(right) > i + max_sr_candle_nr)
+			right->bottom++;
 
-	if (!(*stop_high) && *is_high_rst) {
-		if (test_price->high > cur->high) {
-			if (*candle_high_nr < min_sr_candle_nr - 1)
-				*is_high_rst = 0;
-			else
-				*stop_high = 1;
-		}
-		else if (cur->high < test_price->low) {
-			anna_error("is_high_rst algo error: cur_date=%s, test_date=%s\n", cur->date, test_price->date);
-			(*is_high_rst) = 0;
-		}
-		else {
-			if (cur->high - test_price->low > *max_high_diff)
-				*max_high_diff = cur->high - test_price->low;
-			(*candle_high_nr) += 1;
+		while (!sr_stack_empty(right) && sr_breaks(sr, val, sr_value(&dateprice[sr_stack_top(right)], sr))) {
+			int broken = sr_stack_top(right);
+
+			tracker->span[broken % SR_SPAN_SZ].right[sr] = broken - i - 1;
+			right->top--;
 		}
+
+		/* until a newer row breaks it, all newer rows */
+		span->right[sr] = i < max_sr_candle_nr ? i : max_sr_candle_nr;
+		sr_stack_push(right, i);
 	}
+}
 
-	if (!(*stop_2ndhigh) && *is_2ndhigh_rst) {
-		if (tp_2ndhigh > cur_2ndhigh) {
-			if (*candle_2ndhigh_nr < min_sr_candle_nr - 1)
-				*is_2ndhigh_rst = 0;
-			else
-				*stop_2ndhigh = 1;
-		}
-		else if (cur_2ndhigh < test_price->low) {
-			anna_error("is_2ndhigh_rst algo error: cur_date=%s, test_date=%s\n", cur->date, test_price->date);
-			*(is_2ndhigh_rst) = 0;
-		}
-		else {
-			if (cur_2ndhigh - test_price->low > *max_2ndhigh_diff)
-				*max_2ndhigh_diff = cur_2ndhigh - test_price->low;
-			(*candle_2ndhigh_nr) += 1;
+/*
+ * height of cur's support/resistance over nr rows from row from, step -1 or 1:
+ * the highest high above a support, the depth of the lowest low below a
+ * resistance. -1 if a row is on the wrong side of it (a broken bar).
+ */
+static int64_t sr_height(const struct stock_price *price, const struct date_price *cur, int sr,
+			 int from, int step, int nr)
+{
+	uint64_t cur_val = sr_value(cur, sr);
+	uint64_t height = 0;
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		const struct date_price *test_price = &price->dateprice[from + i * step];
+
+		if (sr < SR_HIGH ? test_price->high < cur_val : test_price->low > cur_val) {
+			anna_error("%s algo error: cur_date=" DATE_FMT ", test_date=" DATE_FMT "\n",
+				   sr_name[sr], DATE_ARG(cur->date), DATE_ARG(test_price->date));
+			return -1;
 		}
+
+		if (sr < SR_HIGH && test_price->high - cur_val > height)
+			height = test_price->high - cur_val;
+		else if (sr >= SR_HIGH && cur_val - test_price->low > height)
+			height = cur_val - test_price->low;
 	}
+
+	return height;
 }
 
 static void calculate_support_bigupday(struct stock_price *price, int cur_idx, struct date_price *cur)
@@ -275,2480 +285,3734 @@ static void calculate_support_bigupday(struct stock_price *price, int cur_idx, s
 		cur->sr_flag = SR_F_BIGUPDAY;
 }
 
-static void calculate_support_resistance(struct stock_price *price, int cur_idx, struct date_price *cur)
+static void calculate_support_resistance(struct stock_price *price, int cur_idx, struct date_price *cur,
+					 const struct sr_span *span)
 {
+	static const uint16_t sr_flag[SR_NR] = {
+		SR_F_SUPPORT_LOW, SR_F_SUPPORT_2ndLOW, SR_F_RESIST_HIGH, SR_F_RESIST_2ndHIGH
+	};
+	struct date_price_cold *cold = &price->cold[cur_idx];
+	uint32_t *height[SR_NR] = {
+		&cold->height_low_spt, &cold->height_2ndlow_spt, &cold->height_high_rst, &cold->height_2ndhigh_rst
+	};
 	int cnt = price->date_cnt - cur_idx;
-	int left_is_low_spt = 1, left_low_stop = 0, left_is_2ndlow_spt = 1, left_2ndlow_stop = 0;
-	int left_is_high_rst = 1, left_high_stop = 0, left_is_2ndhigh_rst = 1, left_2ndhigh_stop = 0;
-	uint64_t left_max_low_diff = 0, left_max_2ndlow_diff = 0;
-	uint64_t left_max_high_diff = 0, left_max_2ndhigh_diff = 0;
-	int left_candle_low_nr = 0, left_candle_2ndlow_nr = 0;
-	int left_candle_high_nr = 0, left_candle_2ndhigh_nr = 0;
-	int right_is_low_spt = 1, right_low_stop = 0, right_is_2ndlow_spt = 1, right_2ndlow_stop = 0;
-	int right_is_high_rst = 1, right_high_stop = 0, right_is_2ndhigh_rst = 1, right_2ndhigh_stop = 0;
-	uint64_t right_max_low_diff = 0, right_max_2ndlow_diff = 0;
-	uint64_t right_max_high_diff = 0, right_max_2ndhigh_diff = 0;
-	int right_candle_low_nr = 0, right_candle_2ndlow_nr = 0;
-	int right_candle_high_nr = 0, right_candle_2ndhigh_nr = 0;
-	int i;
+	int sr;
 
 	/* need at least <min_sr_candle_nr - 1> of candles on left and right */
 	if (cnt < min_sr_candle_nr || (price->date_cnt - cnt) < min_sr_candle_nr - 1)
 		return;
 
-	/* check left side candles */
-	for (i = cur_idx + 1; (i - cur_idx) <= max_sr_candle_nr && i < price->date_cnt; i++) {
-		struct date_price *left = &price->dateprice[i];
+	for (sr = 0; sr < SR_NR; sr++) {
+		int64_t left_height, right_height, max_height;
 
-		if (!left_is_low_spt && !left_is_2ndlow_spt
-		    && !left_is_high_rst && !left_is_2ndhigh_rst)
-			break;
+		if (span->left[sr] < min_sr_candle_nr - 1 || span->right[sr] < min_sr_candle_nr - 1)
+			continue;
 
-		if (left_low_stop && left_2ndlow_stop
-		    && left_high_stop && left_2ndhigh_stop)
-			break;
+		left_height = sr_height(price, cur, sr, cur_idx + 1, 1, span->left[sr]);
+		right_height = sr_height(price, cur, sr, cur_idx - 1, -1, span->right[sr]);
+		if (left_height < 0 || right_height < 0)
+			continue;
 
-		calculate_one_side_sr(cur, left,
-				      &left_is_low_spt, &left_low_stop, &left_candle_low_nr, &left_max_low_diff,
-				      &left_is_2ndlow_spt, &left_2ndlow_stop, &left_candle_2ndlow_nr, &left_max_2ndlow_diff,
-				      &left_is_high_rst, &left_high_stop, &left_candle_high_nr, &left_max_high_diff,
-				      &left_is_2ndhigh_rst, &left_2ndhigh_stop, &left_candle_2ndhigh_nr, &left_max_2ndhigh_diff);
+		max_height = left_height > right_height ? left_height : right_height;
+
+		if (max_height * 100 / (sr < SR_HIGH ? get_2ndlow(cur) : get_2ndhigh(cur)) >= diff_margin_percent) {
+			cur->sr_flag |= sr_flag[sr];
+			*height[sr] = max_height;
+		}
 	}
 
-	/* check right side candles */
-	for (i = cur_idx - 1; (cur_idx - i) <= max_sr_candle_nr && i >= 0; i--) {
-		struct date_price *right = &price->dateprice[i];
+	if (cur->sr_flag)
+		return;
 
-		if (!right_is_low_spt && !right_is_2ndlow_spt
-		    && !right_is_high_rst && !right_is_2ndhigh_rst)
-			break;
+	calculate_support_bigupday(price, cur_idx, cur);
+}
 
-		if (right_low_stop && right_2ndlow_stop
-		    && right_high_stop && right_2ndhigh_stop)
-			break;
+/*
+ * rows go through the statistics a tile at a time, from the oldest one:
+ * candle stats and indicators of the tile, then support/resistance of the
+ * rows whose right spans the tile completed. those look at the rows around
+ * them, which are still in cache.
+ */
+static const int stat_tile_rows = 128;
 
-		calculate_one_side_sr(cur, right,
-				      &right_is_low_spt, &right_low_stop, &right_candle_low_nr, &right_max_low_diff,
-				      &right_is_2ndlow_spt, &right_2ndlow_stop, &right_candle_2ndlow_nr, &right_max_2ndlow_diff,
-				      &right_is_high_rst, &right_high_stop, &right_candle_high_nr, &right_max_high_diff,
-				      &right_is_2ndhigh_rst, &right_2ndhigh_stop, &right_candle_2ndhigh_nr, &right_max_2ndhigh_diff);
-	}
+static void calculate_stat_row(struct stock_price *price, int i)
+{
+	struct date_price *cur = &price->dateprice[i];
+	struct date_price_cold *cold = &price->cold[i];
 
-	int left_ok = left_is_low_spt && (left_low_stop || left_candle_low_nr >= min_sr_candle_nr - 1);
-	int left_height_ok = (left_max_low_diff * 100 / get_2ndlow(cur) >= diff_margin_percent);
-	int right_ok = right_is_low_spt && (right_low_stop || right_candle_low_nr >= min_sr_candle_nr - 1);
-	int right_height_ok = (right_max_low_diff * 100 / get_2ndlow(cur) >= diff_margin_percent);
+	indicators_step(price, i + 1, &price->state, cur);
 
-	if (left_ok && right_ok && (left_height_ok || right_height_ok)) {
-		cur->sr_flag |= SR_F_SUPPORT_LOW;
-		cur->height_low_spt = left_max_low_diff > right_max_low_diff ? left_max_low_diff : right_max_low_diff;
-	}
+	cold->typical_price = typical_price(cur);
+	cold->raw_mf = raw_mf(cur);
+}
 
-	left_ok = left_is_2ndlow_spt && (left_2ndlow_stop || left_candle_2ndlow_nr >= min_sr_candle_nr - 1);
-	left_height_ok = (left_max_2ndlow_diff * 100 / get_2ndlow(cur) >= diff_margin_percent);
-	right_ok = right_is_2ndlow_spt && (right_2ndlow_stop || right_candle_2ndlow_nr >= min_sr_candle_nr - 1);
-	right_height_ok = (right_max_2ndlow_diff * 100 / get_2ndlow(cur) >= diff_margin_percent);
+static void calculate_sr_row(struct stock_price *price, int i, const struct sr_span *span)
+{
+	struct date_price *cur = &price->dateprice[i];
+	struct date_price_cold *cold = &price->cold[i];
 
-	if (left_ok && right_ok && (left_height_ok || right_height_ok)) {
-		cur->sr_flag |= SR_F_SUPPORT_2ndLOW;
-		cur->height_2ndlow_spt = left_max_2ndlow_diff > right_max_2ndlow_diff ? left_max_2ndlow_diff : right_max_2ndlow_diff;
-	}
+	cur->sr_flag = 0;
+	cold->height_low_spt = cold->height_2ndlow_spt = 0;
+	cold->height_high_rst = cold->height_2ndhigh_rst = 0;
 
-	left_ok = left_is_high_rst && (left_high_stop || left_candle_high_nr >= min_sr_candle_nr - 1);
-	left_height_ok = (left_max_high_diff * 100 / get_2ndhigh(cur) >= diff_margin_percent);
-	right_ok = right_is_high_rst && (right_high_stop || right_candle_high_nr >= min_sr_candle_nr - 1);
-        right_height_ok = (right_max_high_diff * 100 / get_2ndhigh(cur) >= diff_margin_percent);
+	if (cur->open && cur->high && cur->low && cur->close)
+		calculate_support_resistance(price, i, cur, span);
+}
 
-	if (left_ok && right_ok && (left_height_ok || right_height_ok)) {
-		cur->sr_flag |= SR_F_RESIST_HIGH;
-		cur->height_high_rst = left_max_high_diff > right_max_high_diff ? left_max_high_diff : right_max_high_diff;
-	}
+/*
+ * statistics of the stat_nr latest rows, carrying on from price->state at
+ * row stat_nr. support/resistance of the sr_nr latest rows, and of the
+ * bigupday_nr latest rows that have none or a big up day only (sr_nr <=
+ * bigupday_nr). the other rows already have theirs.
+ */
+static void calculate_statistics(struct stock_price *price, int stat_nr, int sr_nr, int bigupday_nr)
+{
+	struct sr_tracker tracker;
+	int row_nr, sr_next;
+	int i, end;
 
-	left_ok = left_is_2ndhigh_rst && (left_2ndhigh_stop || left_candle_2ndhigh_nr >= min_sr_candle_nr - 1);
-        left_height_ok = (left_max_2ndhigh_diff * 100 / get_2ndhigh(cur) >= diff_margin_percent);
-	right_ok = right_is_2ndhigh_rst && (right_2ndhigh_stop || right_candle_2ndhigh_nr >= min_sr_candle_nr - 1);
-	right_height_ok = (right_max_2ndhigh_diff * 100 / get_2ndhigh(cur) >= diff_margin_percent);
+	/* the spans of a row look at max_sr_candle_nr rows on its left */
+	row_nr = bigupday_nr + max_sr_candle_nr;
+	if (row_nr > price->date_cnt)
+		row_nr = price->date_cnt;
 
-	if (left_ok && right_ok && (left_height_ok || right_height_ok)) {
-		cur->sr_flag |= SR_F_RESIST_2ndHIGH;
-		cur->height_2ndhigh_rst = left_max_2ndhigh_diff > right_max_2ndhigh_diff ? left_max_2ndhigh_diff : right_max_2ndhigh_diff;
-	}
+	sr_tracker_init(&tracker, price);
 
-	if (cur->sr_flag)
-		return;
+	for (i = sr_next = row_nr - 1; i >= 0; ) {
+		end = i - stat_tile_rows + 1;
+		if (end < 0)
+			end = 0;
 
-	calculate_support_bigupday(price, cur_idx, cur);
+		if (end < stat_nr)
+			calculate_candle_stats(&price->dateprice[end], (i < stat_nr ? i + 1 : stat_nr) - end);
+
+		for (; i >= end; i--) {
+			if (i < stat_nr)
+				calculate_stat_row(price, i);
+
+			sr_tracker_push(&tracker, i);
+		}
+
+		/* right spans are complete max_sr_candle_nr rows behind */
+		end = end ? end + max_sr_candle_nr : 0;
+
+		for (; sr_next >= end; sr_next--) {
+			const struct date_price *cur = &price->dateprice[sr_next];
+
+			if (sr_next >= bigupday_nr
+			    || (sr_next >= sr_nr && (cur->sr_flag & ~SR_F_BIGUPDAY)))
+				continue;
+
+			calculate_sr_row(price, sr_next, sr_tracker_span(&tracker, sr_next));
+		}
+	}
 }
 
 static void calculate_stock_price_statistics(struct stock_price *price)
 {
-	uint64_t price_sum[SMA_NR] = { 0 };
-	uint64_t volume_sum[VMA_NR] = { 0 };
-	uint64_t positive_raw_mf = 0, negative_raw_mf = 0;
-	int i, j;
+	memset(&price->state, 0, sizeof(price->state));
 
-	for (i = price->date_cnt - 1; i >= 0; i--) {
-		struct date_price *cur = &price->dateprice[i];
+	calculate_statistics(price, price->date_cnt, price->date_cnt, price->date_cnt);
+}
 
-		for (j = 0; j < SMA_NR; j++)
-			calculate_sma(price, i, j, &price_sum[j], cur);
+/*
+ * calculate statistics of the new_nr latest rows, older rows already have theirs.
+ * the averages and money flow carry on from price->state at the row before
+ * them (rebuilt from its windows if it's not stored), so the result is the
+ * same as calculate_stock_price_statistics() over all rows. returns the
+ * number of latest rows whose values are (re)calculated.
+ */
+static int calculate_stock_price_statistics_since(struct stock_price *price, int new_nr)
+{
+	int sr_nr, bigupday_nr;
 
-		for (j = 0; j < VMA_NR; j++)
-			calculate_vma(price, i, j, &volume_sum[j], cur);
+	if (!price_state_valid_at(price, new_nr))
+		indicators_build(price, new_nr, &price->state);
 
-		calculate_mfi(price, i, cur, &positive_raw_mf, &negative_raw_mf);
+	/* support/resistance of a row looks at max_sr_candle_nr rows on its right */
+	sr_nr = new_nr + max_sr_candle_nr;
+	if (sr_nr > price->date_cnt)
+		sr_nr = price->date_cnt;
 
-		calculate_candle_stats(cur);
+	/* and a big up day at any older row whose rising closes reach the new rows */
+	for (bigupday_nr = new_nr + 1; bigupday_nr < price->date_cnt; bigupday_nr++) {
+		if (price->dateprice[bigupday_nr - 1].close <= price->dateprice[bigupday_nr].close)
+			break;
 	}
 
-	for (i = price->date_cnt - 1; i >= 0; i--) {
-		struct date_price *cur = &price->dateprice[i];
+	if (bigupday_nr < sr_nr)
+		bigupday_nr = sr_nr;
 
-		if (cur->open && cur->high && cur->low && cur->close)
-			calculate_support_resistance(price, i, cur);
-	}
+	calculate_statistics(price, new_nr, sr_nr, bigupday_nr);
+
+	return bigupday_nr;
 }
 
-static int str_to_price(char *buf, struct date_price *price)
+/*
+ * add bars newer than price's latest date in front of price and calculate
+ * their statistics, see calculate_stock_price_statistics_since().
+ * returns the number of latest rows to be written back.
+ */
+int stock_price_append(struct stock_price *price, const struct stock_price *bars)
 {
-	char *token;
+	int old_nr = price->date_cnt;
+	int new_nr = 0;
 	int i;
 
-	token = strtok(buf, ",");
-	if (!token) return -1;
-	strlcpy(price->date, token, sizeof(price->date));
-
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->wday = atoi(token);
-
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->open = atoi(token);
+	if (price->readonly) {
+		anna_error("can't append to a read-only price\n");
+		return -1;
+	}
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->high = atoi(token);
+	while (new_nr < bars->date_cnt
+	       && (!old_nr || bars->dateprice[new_nr].date > price->dateprice[0].date))
+		new_nr += 1;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->low = atoi(token);
+	if (!new_nr)
+		return 0;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->close = atoi(token);
+	if (stock_price_reserve(price, old_nr + new_nr) < 0)
+		return -1;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->volume = atoi(token);
+	memmove(&price->dateprice[new_nr], &price->dateprice[0], sizeof(struct date_price) * old_nr);
+	memcpy(&price->dateprice[0], &bars->dateprice[0], sizeof(struct date_price) * new_nr);
+	memmove(&price->cold[new_nr], &price->cold[0], sizeof(struct date_price_cold) * old_nr);
+	memcpy(&price->cold[0], &bars->cold[0], sizeof(struct date_price_cold) * new_nr);
+	price->date_cnt = old_nr + new_nr;
 
+	for (i = 0; i < new_nr; i++) {
+		struct date_price *cur = &price->dateprice[i];
+		struct date_price_cold *cold = &price->cold[i];
 
-	for (i = 0; i < SMA_NR; i++) {
-		token = strtok(NULL, ",");
-		if (!token) return -1;
-		price->sma[i] = atoi(token);
+		memset(cur->sma, 0, sizeof(cur->sma));
+		memset(cur->vma, 0, sizeof(cur->vma));
+		cur->mfi = 0;
+		cur->sr_flag = 0;
+		cold->height_low_spt = cold->height_2ndlow_spt = 0;
+		cold->height_high_rst = cold->height_2ndhigh_rst = 0;
 	}
 
-	for (i = 0; i < VMA_NR; i++) {
-		token = strtok(NULL, ",");
-		if (!token) return -1;
-		price->vma[i] = atoi(token);
+	/* same as stock_price_from_file(), there is no statistics below 21 rows */
+	if (old_nr <= 20) {
+		if (price->date_cnt > 20)
+			calculate_stock_price_statistics(price);
+		return price->date_cnt;
 	}
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->mfi = atoi(token);
-
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->candle_color = atoi(token);
-
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->candle_trend = atoi(token);
+	return calculate_stock_price_statistics_since(price, new_nr);
+}
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->sr_flag = atoi(token);
+/*
+ * sma[], vma[], mfi and candle stats of bar, one day newer than the latest
+ * row of price, e.g. today's realtime price. price is not changed.
+ * returns -1 if price has too few rows for statistics, bar only gets its
+ * candle stats then.
+ */
+int stock_price_next_bar(const struct stock_price *price, struct date_price *bar)
+{
+	struct price_state state;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->height_low_spt = atoi(token);
+	calculate_candle_stats(bar, 1);
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->height_2ndlow_spt = atoi(token);
+	if (price->date_cnt <= 20)
+		return -1;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->height_high_rst = atoi(token);
+	if (stock_price_state_valid(price))
+		state = price->state;
+	else
+		indicators_build(price, 0, &state);
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->height_2ndhigh_rst = atoi(token);
+	indicators_step(price, 0, &state, bar);
 
 	return 0;
 }
 
-int stock_price_history_from_file(const char *fname, struct stock_price *price)
+/*
+ * make price->dateprice and price->cold writable buffers for at least
+ * date_cnt rows, rows already in them are kept. a read-only price is released first. the first
+ * buffer is sized exactly, e.g. from a file header, it is doubled when grown
+ * row by row.
+ */
+int stock_price_reserve(struct stock_price *price, int date_cnt)
 {
-	FILE *fp;
-	char buf[1024];
-
-	if (!fname || !fname[0] || !price) {
-		anna_error("invalid input parameters\n");
-		return -1;
-	}
-
-	price->date_cnt = 0;
+	struct date_price *dateprice;
+	struct date_price_cold *cold;
+	int date_max;
 
-	fp = fopen(fname, "r");
-	if (!fp) {
-		anna_error("fopen(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
-		return -1;
-	}
+	/* the rows are about to change */
+	price->sums.row_nr = 0;
+	price->ranges.row_nr = 0;
+	price->levels.row_nr = 0;
+	price->patterns.row_nr = 0;
 
-	price->sector[0] = 0;
+	if (price->readonly)
+		stock_price_free(price);
 
-	while (fgets(buf, sizeof(buf), fp)) {
-		if (buf[0] == '#')
-			continue;
+	if (price->dateprice && date_cnt <= price->date_max)
+		return 0;
 
-		if (buf[0] == '%') {
-			buf[strlen(buf) - 1] = 0;
-			if (strncmp(&buf[1], "sector=", strlen("sector=")) == 0)
-				strlcpy(price->sector, strchr(buf, '=') + 1, sizeof(price->sector));
-			continue;
-		}
+	date_max = price->date_max * 2;
+	if (date_max < date_cnt)
+		date_max = date_cnt;
+	if (date_max < 1)
+		date_max = 1;
 
-		if (price->date_cnt >= DATE_PRICE_SZ_MAX) {
-			anna_error("fname='%s', date_cnt=%d>%d\n", fname, price->date_cnt, DATE_PRICE_SZ_MAX);
-			return -1;
-		}
+	dateprice = realloc(price->dateprice, sizeof(struct date_price) * date_max);
+	if (!dateprice) {
+		anna_error("realloc(%zu) failed\n", sizeof(struct date_price) * date_max);
+		return -1;
+	}
 
-		if (str_to_price(buf, &price->dateprice[price->date_cnt]) < 0)
-			continue;
+	price->dateprice = dateprice;
 
-		price->date_cnt += 1;
+	cold = realloc(price->cold, sizeof(struct date_price_cold) * date_max);
+	if (!cold) {
+		anna_error("realloc(%zu) failed\n", sizeof(struct date_price_cold) * date_max);
+		return -1;
 	}
 
-	fclose(fp);
+	price->cold = cold;
+	price->date_max = date_max;
 
 	return 0;
 }
 
-int stock_price_realtime_from_file(const char *output_fname, struct date_price *price)
+void stock_price_free(struct stock_price *price)
 {
-	char buf[1024];
-	char *token;
-
-	FILE *fp = fopen(output_fname, "r");
-	if (!fp) {
-		anna_error("fopen(%s) failed: %d(%s)\n", output_fname, errno, strerror(errno));
-		return -1;
-	}
-
-	if (!fgets(buf, sizeof(buf), fp)) {
-		anna_error("fgets(%s) failed: %d(%s)\n", output_fname, errno, strerror(errno));
-		return -1;
+	if (price->map_addr)
+		munmap(price->map_addr, price->map_len);
+	else if (!price->readonly) {
+		free(price->dateprice);
+		free(price->cold);
 	}
 
-	if (!isdigit(buf[0]))
-		return -1;
+	price->dateprice = NULL;
+	price->cold = NULL;
+	price->readonly = 0;
+	price->map_addr = NULL;
+	price->map_len = 0;
+	price->date_cnt = 0;
+	price->date_max = 0;
+	price->state.date = 0;
+
+	free(price->sums.close);
+	memset(&price->sums, 0, sizeof(price->sums));
+	free(price->ranges.table[0]);
+	memset(&price->ranges, 0, sizeof(price->ranges));
+	free(price->levels.level);
+	memset(&price->levels, 0, sizeof(price->levels));
+	free(price->patterns.bits);
+	memset(&price->patterns, 0, sizeof(price->patterns));
+}
+
+/*
+ * build price->sums for all rows, if they are not yet. stock_price_sma(),
+ * stock_price_vma() and stock_price_mfi() answer from them.
+ */
+int stock_price_sums(struct stock_price *price)
+{
+	struct price_sums *sums = &price->sums;
+	int n = price->date_cnt;
+	uint64_t *buf;
+	int i;
 
-	token = strtok(buf, ",");
-	if (!token) return -1;
-	parse_price(token, &price->open);
+	if (sums->row_nr == n && sums->close)
+		return 0;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	parse_price(token, &price->high);
+	buf = realloc(sums->close, sizeof(uint64_t) * (n + 1) * 4);
+	if (!buf) {
+		anna_error("realloc(%zu) failed\n", sizeof(uint64_t) * (n + 1) * 4);
+		return -1;
+	}
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	parse_price(token, &price->low);
+	sums->close = buf;
+	sums->volume = sums->close + n + 1;
+	sums->positive_mf = sums->volume + n + 1;
+	sums->negative_mf = sums->positive_mf + n + 1;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	parse_price(token, &price->close);
+	sums->close[n] = sums->volume[n] = 0;
+	sums->positive_mf[n] = sums->negative_mf[n] = 0;
 
-	token = strtok(NULL, ",");
-	if (!token) return -1;
-	price->volume = atoi(token);
+	for (i = n - 1; i >= 0; i--) {
+		const struct date_price *cur = &price->dateprice[i];
+		uint64_t mf = raw_mf(cur);
+		/* same as the mfi indicator */
+		int positive = i == n - 1 || typical_price(cur) >= typical_price(cur + 1);
 
-	fclose(fp);
+		sums->close[i] = sums->close[i + 1] + cur->close;
+		sums->volume[i] = sums->volume[i + 1] + cur->volume;
+		sums->positive_mf[i] = sums->positive_mf[i + 1] + (positive ? mf : 0);
+		sums->negative_mf[i] = sums->negative_mf[i + 1] + (positive ? 0 : mf);
+	}
 
-	calculate_candle_stats(price);
+	sums->row_nr = n;
 
 	return 0;
 }
 
-static int month_str2int(const char *str)
+/* 0 unless the sums are built and rows idx .. idx+days-1 exist */
+static int price_sums_window(const struct price_sums *sums, int idx, int days)
 {
-	if (strncmp(str, "Jan", 3) == 0)
-		return 1;
-	else if (strncmp(str, "Feb", 3) == 0)
-		return 2;
-	else if (strncmp(str, "Mar", 3) == 0)
-		return 3;
-	else if (strncmp(str, "Apr", 3) == 0)
-		return 4;
-	else if (strncmp(str, "May", 3) == 0)
-		return 5;
-	else if (strncmp(str, "Jun", 3) == 0)
-		return 6;
-	else if (strncmp(str, "Jul", 3) == 0)
-		return 7;
-	else if (strncmp(str, "Aug", 3) == 0)
-		return 8;
-	else if (strncmp(str, "Sep", 3) == 0)
-		return 9;
-	else if (strncmp(str, "Oct", 3) == 0)
-		return 10;
-	else if (strncmp(str, "Nov", 3) == 0)
-		return 11;
-	else if (strncmp(str, "Dec", 3) == 0)
-		return 12;
-	return 0;
+	return sums->close && idx >= 0 && days > 0 && idx + days <= sums->row_nr;
 }
 
-static int str2date(const char *date, int *year, int *month, int *mday)
+static uint32_t price_range_value(const struct date_price *p, int range)
 {
-	char _date[32];
-	char *token, *saved;
-
-	strlcpy(_date, date, sizeof(_date));
+	switch (range) {
+	case PRICE_RANGE_HIGH:
+		return p->high;
+	case PRICE_RANGE_2ndHIGH:
+		return get_2ndhigh(p);
+	case PRICE_RANGE_LOW:
+		return p->low;
+	case PRICE_RANGE_2ndLOW:
+		return get_2ndlow(p);
+	default:
+		return p->volume;
+	}
+}
 
-	switch (fetch_source) {
-	case FETCH_SOURCE_GOOGLE:
-		token = strtok_r(_date, "-", &saved);
-		if (!token) return -1;
-		*mday = atoi(token);
+#define price_range_is_max(range)	((range) <= PRICE_RANGE_2ndHIGH)
+#define price_range_pick(range, a, b) \
+	(price_range_is_max(range) ? ((a) > (b) ? (a) : (b)) : ((a) < (b) ? (a) : (b)))
 
-		token = strtok_r(NULL, "-", &saved);
-		if (!token) return -1;
-		*month = month_str2int(token);
+/*
+ * build price->ranges for all rows, if they are not yet. stock_price_range()
+ * answers from them.
+ */
+int stock_price_ranges(struct stock_price *price)
+{
+	struct price_ranges *ranges = &price->ranges;
+	int n = price->date_cnt;
+	int level_nr, range, k, i;
+	uint32_t *buf;
 
-		token = strtok_r(NULL, "-", &saved);
-		if (!token) return -1;
-		*year = 2000 + atoi(token);
+	if (ranges->row_nr == n && ranges->table[0])
+		return 0;
 
-		break;
+	for (level_nr = 1; (1 << level_nr) <= n; level_nr++)
+		;
 
-	case FETCH_SOURCE_YAHOO:
-		token = strtok_r(_date, "-", &saved);
-		if (!token) return -1;
-		*year = atoi(token);
+	buf = realloc(ranges->table[0], sizeof(uint32_t) * level_nr * (n ? n : 1) * PRICE_RANGE_NR);
+	if (!buf) {
+		anna_error("realloc(%zu) failed\n", sizeof(uint32_t) * level_nr * n * PRICE_RANGE_NR);
+		return -1;
+	}
 
-		token = strtok_r(NULL, "-", &saved);
-		if (!token) return -1;
-		*month = atoi(token);
+	for (range = 0; range < PRICE_RANGE_NR; range++) {
+		uint32_t *table = ranges->table[range] = buf + (size_t)range * level_nr * n;
 
-		token = strtok_r(NULL, "-", &saved);
-		if (!token) return -1;
-		*mday = atoi(token);
+		for (i = 0; i < n; i++)
+			table[i] = price_range_value(&price->dateprice[i], range);
 
-		break;
+		for (k = 1; k < level_nr; k++) {
+			uint32_t *level = table + k * n, *half = level - n;
 
-	default:
-		return -1;
+			for (i = 0; i + (1 << k) <= n; i++)
+				level[i] = price_range_pick(range, half[i], half[i + (1 << (k - 1))]);
+		}
 	}
 
+	ranges->row_nr = n;
+	ranges->level_nr = level_nr;
+
 	return 0;
 }
 
-static int dayofweek(int year, int month, int mday)
+/*
+ * the highest (PRICE_RANGE_HIGH, PRICE_RANGE_2ndHIGH) or lowest value of
+ * rows idx .. idx+nr-1, the window stops at the oldest row. 0 for the
+ * highest and (uint32_t)-1 for the lowest of no rows.
+ */
+uint32_t stock_price_range(const struct stock_price *price, int range, int idx, int nr)
 {
-	static int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
-	year -= month < 3;
-	return ( year + year/4 - year/100 + year/400 + t[month-1] + mday) % 7;
+	const struct price_ranges *ranges = &price->ranges;
+	const uint32_t *level;
+	int k;
+
+	if (idx < 0) {
+		nr += idx;
+		idx = 0;
+	}
+	if (nr > ranges->row_nr - idx)
+		nr = ranges->row_nr - idx;
+	if (!ranges->table[0] || nr <= 0)
+		return price_range_is_max(range) ? 0 : (uint32_t)-1;
+
+	k = 31 - __builtin_clz(nr);
+	level = ranges->table[range] + k * ranges->row_nr;
+
+	return price_range_pick(range, level[idx], level[idx + nr - (1 << k)]);
 }
 
-int stock_price_from_file(const char *fname, struct stock_price *price)
+static int price_level_cmp(const void *a, const void *b)
 {
-	FILE *fp;
-	char buf[1024];
+	const struct price_level *l1 = a, *l2 = b;
 
-	if (!fname || !fname[0] || !price) {
-		anna_error("invalid input parameters\n");
-		return -1;
-	}
+	if (l1->price != l2->price)
+		return l1->price < l2->price ? -1 : 1;
 
-	price->date_cnt = 0;
+	return l1->row - l2->row;
+}
 
-	fp = fopen(fname, "r");
-	if (!fp) {
-		anna_error("fopen(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+/*
+ * build price->levels, if they are not yet. levels with a price close to
+ * a check's price are found by stock_price_level_find() instead of going
+ * over every row for its sr_flag.
+ */
+int stock_price_levels(struct stock_price *price)
+{
+	static const uint16_t sr_flags[ ] = {
+		SR_F_SUPPORT_LOW, SR_F_SUPPORT_2ndLOW, SR_F_RESIST_HIGH, SR_F_RESIST_2ndHIGH,
+	};
+	struct price_levels *levels = &price->levels;
+	struct price_level *level;
+	int level_nr = 0;
+	int i, k;
+
+	if (levels->row_nr == price->date_cnt && levels->level)
+		return 0;
+
+	for (i = 0; i < price->date_cnt; i++) {
+		for (k = 0; k < 4; k++)
+			level_nr += !!(price->dateprice[i].sr_flag & sr_flags[k]);
+	}
+
+	level = realloc(levels->level, sizeof(*level) * (level_nr ? level_nr : 1));
+	if (!level) {
+		anna_error("realloc(%zu) failed\n", sizeof(*level) * level_nr);
 		return -1;
 	}
 
-	/* skip the 1st line */
-	fgets(buf, sizeof(buf), fp);
+	levels->level = level;
+	levels->level_nr = level_nr;
 
-	while (fgets(buf, sizeof(buf), fp)) {
-		int year, month, mday;
+	for (i = 0; i < price->date_cnt; i++) {
+		const struct date_price *p = &price->dateprice[i];
+		const struct date_price_cold *cold = &price->cold[i];
 
-		if (price->date_cnt >= DATE_PRICE_SZ_MAX) {
-			anna_error("fname='%s', date_cnt=%d>%d\n", fname, price->date_cnt, DATE_PRICE_SZ_MAX);
-			return -1;
-		}
+		for (k = 0; k < 4; k++) {
+			if (!(p->sr_flag & sr_flags[k]))
+				continue;
 
-		struct date_price *cur = &price->dateprice[price->date_cnt];
-		char *token;
-		uint32_t  adj_close;
+			level->row = i;
+			level->sr_flag = sr_flags[k];
 
-		token = strtok(buf, ",");
-		if (!token) continue;
-		strlcpy(cur->date, token, sizeof(cur->date));
+			switch (sr_flags[k]) {
+			case SR_F_SUPPORT_LOW:
+				level->price = p->low;
+				level->height = cold->height_low_spt;
+				break;
+			case SR_F_SUPPORT_2ndLOW:
+				level->price = get_2ndlow(p);
+				level->height = cold->height_2ndlow_spt;
+				break;
+			case SR_F_RESIST_HIGH:
+				level->price = p->high;
+				level->height = cold->height_high_rst;
+				break;
+			case SR_F_RESIST_2ndHIGH:
+				level->price = get_2ndhigh(p);
+				level->height = cold->height_2ndhigh_rst;
+				break;
+			}
 
-		if (str2date(cur->date, &year, &month, &mday) < 0)
-			anna_error("str2date(%s) failed\n", cur->date);
-		else {
-			snprintf(cur->date, sizeof(cur->date), "%04d-%02d-%02d", year, month, mday);
-			cur->wday = dayofweek(year, month, mday);
+			level++;
 		}
+	}
 
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		parse_price(token, &cur->open);
-
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		parse_price(token, &cur->high);
+	qsort(levels->level, level_nr, sizeof(*level), price_level_cmp);
 
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		parse_price(token, &cur->low);
+	levels->row_nr = price->date_cnt;
 
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		parse_price(token, &cur->close);
+	return 0;
+}
 
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		cur->volume = atoi(token);
+/* index of the first level at or above level_price, level_nr if there is none */
+int stock_price_level_find(const struct stock_price *price, uint32_t level_price)
+{
+	const struct price_levels *levels = &price->levels;
+	int lo = 0, hi = levels->level_nr;
 
-		if (fetch_source == FETCH_SOURCE_GOOGLE)
-			goto next_date;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
 
-		token = strtok(NULL, ",");
-		if (!token) continue;
-		parse_price(token, &adj_close);
+		if (levels->level[mid].price < level_price)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-		if (cur->close != adj_close) {
-			uint32_t diff = cur->close > adj_close ? cur->close - adj_close : adj_close - cur->close;
+	return lo;
+}
 
-			if (diff * 100 / cur->close > 5) {
-				cur->open = ((uint64_t)cur->open) * adj_close / cur->close;
-				cur->high = ((uint64_t)cur->high) * adj_close /cur->close;
-				cur->low = ((uint64_t)cur->low) * adj_close / cur->close;
-				cur->close = adj_close;
-			}
-		}
-next_date:
-		price->date_cnt += 1;
-	}
+/*
+ * CANDLE_P_xxx of p, from prev_nr (up to 3) rows before it, latest first,
+ * and the bits of prev[0]. all of them are tested, without branches.
+ */
+static uint16_t candle_pattern(const struct date_price *p, const struct date_price *prev, int prev_nr,
+			       uint16_t prev_bits)
+{
+	uint32_t body_high = p->close > p->open ? p->close : p->open;
+	uint32_t body_low = p->close < p->open ? p->close : p->open;
+	int has_3d = prev_nr >= 3;
+	int hh, hl;
+	uint16_t bits;
 
-	fclose(fp);
+	if (!prev_nr)
+		return 0;
 
-	if (price->date_cnt > 20)
-		calculate_stock_price_statistics(price);
+	hh = p->high > prev[0].high;
+	hl = p->low > prev[0].low;
 
-	return 0;
-}
+	bits = (p->high <= prev[0].high && p->low >= prev[0].low) * CANDLE_P_INSIDE
+	       | (p->candle_color == CANDLE_COLOR_GREEN && prev[0].candle_color == CANDLE_COLOR_RED
+		  && body_high >= prev[0].open && body_low <= prev[0].close) * CANDLE_P_BULL_ENGULF
+	       | (p->candle_color == CANDLE_COLOR_RED && prev[0].candle_color == CANDLE_COLOR_GREEN
+		  && body_high >= prev[0].close && body_low <= prev[0].open) * CANDLE_P_BEAR_ENGULF
+	       | hh * CANDLE_P_HH
+	       | (hh && (prev_bits & CANDLE_P_HH)) * CANDLE_P_HH2
+	       | (hh && (prev_bits & CANDLE_P_HH2)) * CANDLE_P_HH3
+	       | hl * CANDLE_P_HL
+	       | (hl && (prev_bits & CANDLE_P_HL)) * CANDLE_P_HL2
+	       | (hl && (prev_bits & CANDLE_P_HL2)) * CANDLE_P_HL3
+	       | (p->close > prev[0].high) * CANDLE_P_CLOSE_OVER_HIGH
+	       | (p->candle_color == CANDLE_COLOR_RED && prev[0].candle_color == CANDLE_COLOR_GREEN) * CANDLE_P_RED_AFTER_GREEN;
 
-void fprintf_date_price(FILE *fp, const struct date_price *p)
-{
-	fprintf(fp,
-		"%s,%u,%u,%u,%u,%u,%u," /* date, wday, open, high, low, close, volume */
-		"%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u," /* sma_10/20/30/50/60/100/120/200d, vma_10/20/60d, mfi */
-		"%u,%u,%u,%u,%u,%u,%u\n",
-		p->date, p->wday, p->open, p->high, p->low, p->close, p->volume,
-		p->sma[SMA_10d], p->sma[SMA_20d], p->sma[SMA_30d], p->sma[SMA_50d],
-		p->sma[SMA_60d], p->sma[SMA_100d], p->sma[SMA_120d], p->sma[SMA_200d],
-		p->vma[VMA_10d], p->vma[VMA_20d], p->vma[VMA_60d], p->mfi,
-		p->candle_color, p->candle_trend, p->sr_flag,
-		p->height_low_spt, p->height_2ndlow_spt, p->height_high_rst, p->height_2ndhigh_rst);
+	if (has_3d) {
+		uint32_t high_3d = prev[0].high;
+
+		if (high_3d < prev[1].high)
+			high_3d = prev[1].high;
+		if (high_3d < prev[2].high)
+			high_3d = prev[2].high;
+
+		bits |= (p->high >= high_3d) * CANDLE_P_HIGH_3D | (p->low >= high_3d) * CANDLE_P_LOW_OVER_3D;
+	}
+
+	return bits;
 }
 
-int stock_price_to_file(const char *group, const char *sector, const char *symbol, const struct stock_price *price)
+/*
+ * build price->patterns, if they are not yet, from the oldest row so a
+ * row's runs carry on from the day before.
+ */
+int stock_price_patterns(struct stock_price *price)
 {
-	char output_fname[256];
-	FILE *fp;
+	struct price_patterns *patterns = &price->patterns;
+	int n = price->date_cnt;
+	uint16_t *bits;
 	int i;
 
-	snprintf(output_fname, sizeof(output_fname), ROOT_DIR "/%s/%s.price", group, symbol);
-	fp = fopen(output_fname, "w");
-	if (!fp) {
-		anna_error("fopen(%s) failed: %d(%s)\n", output_fname, errno, strerror(errno));
+	if (patterns->row_nr == n && patterns->bits)
+		return 0;
+
+	bits = realloc(patterns->bits, sizeof(*bits) * (n ? n : 1));
+	if (!bits) {
+		anna_error("realloc(%zu) failed\n", sizeof(*bits) * n);
 		return -1;
 	}
 
-	if (sector && sector[0])
-		fprintf(fp, "%%sector=%s\n", sector);
+	patterns->bits = bits;
 
-	fprintf(fp, "# date,wday, open, high, low, close, volume, sma10d,20d,30d,50d,60d,100d,120d,200d, "
-		    "vma10d,20d,60d, mfi, candle_color, candle_trend, sr_flag, height_low_spt,2ndlow_spt,high_rst,2ndhigh_rst\n");
+	for (i = n - 1; i >= 0; i--) {
+		int prev_nr = n - 1 - i;
 
-	for (i = 0; i < price->date_cnt; i++) {
-		fprintf_date_price(fp, &price->dateprice[i]);
+		bits[i] = candle_pattern(&price->dateprice[i], &price->dateprice[i + 1], prev_nr > 3 ? 3 : prev_nr,
+					 i + 1 < n ? bits[i + 1] : 0);
 	}
 
-	fclose(fp);
+	patterns->row_nr = n;
 
 	return 0;
 }
 
-
-struct stock_support
+/*
+ * the first row older than date, date_cnt if there is none. rows are latest
+ * first with strictly decreasing dates, so it's a binary search, and row
+ * i is the one of date if it's in the history for i = date_before(date + 1).
+ */
+int stock_price_date_before(const struct stock_price *price, uint32_t date)
 {
-#define STOCK_SUPPORT_MAX_DATES  48
-	char date[STOCK_SUPPORT_MAX_DATES][STOCK_DATE_SZ];
-	uint8_t sr_flag[STOCK_SUPPORT_MAX_DATES];
-	int8_t  is_doublebottom[STOCK_SUPPORT_MAX_DATES];
-	uint32_t  mfi[STOCK_SUPPORT_MAX_DATES];
-	int date_nr;
-	uint32_t avg_spt_price;
-};
+	int lo = 0, hi = price->date_cnt;
 
-static int sr_height_margin_datecnt(uint64_t height, uint64_t base, int datecnt)
-{
-	return (height * 1000 / base >= sr_height_margin);
-#if 0
-	if (datecnt <= 63) { /* 0 ~ 3 month */
-		return (height * 100 / base >= 4) ? 1 : 0;
-	}
-	else if (datecnt <= 126) { /* 3 ~ 6 month */
-		return (height * 100 /base >= 5) ? 1 : 0;
-	}
-	else if (datecnt <= 252) { /* 6 month ~ 1 year */
-		return (height * 100 /base >= 6) ? 1 : 0;
-	}
-	else { /* > 1 year */
-		return (height * 100 / base >= 8) ? 1 : 0;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (price->dateprice[mid].date < date)
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
-#endif
-}
 
-static int sr_hit(uint64_t price2check, uint64_t base_price)
-{
-	uint64_t diff = price2check > base_price ? price2check - base_price : base_price - price2check;
-	return (diff * 1000 / base_price <= 15);
+	return lo;
 }
 
-static int sma_hit(uint64_t price2check, uint64_t sma_price)
+/* days simple moving average of close at row idx, 0 if there are less than days rows from idx */
+uint32_t stock_price_sma(const struct stock_price *price, int idx, int days)
 {
-	uint64_t diff = price2check > sma_price ? price2check - sma_price : sma_price - price2check;
-	return (diff * 1000 / sma_price <= 10);
-}
+	const struct price_sums *sums = &price->sums;
 
-static int bo_hit(uint64_t price2check, uint64_t base_price)
-{
-	uint64_t diff = price2check > base_price ? price2check - base_price : base_price - price2check;
-	return (diff * 1000 / base_price >= 20);
-}
+	if (!price_sums_window(sums, idx, days))
+		return 0;
 
-static void date2sspt_copy(const struct date_price *prev, struct stock_support *sspt, int8_t is_db)
-{
-	strlcpy(sspt->date[sspt->date_nr], prev->date, sizeof(sspt->date[0]));
-	sspt->sr_flag[sspt->date_nr] = prev->sr_flag;
-	sspt->is_doublebottom[sspt->date_nr] = is_db;
-	sspt->mfi[sspt->date_nr] = prev->mfi;
-	sspt->date_nr += 1;
+	return (sums->close[idx] - sums->close[idx + days]) / days;
 }
 
-static int date_is_downtrend(const struct stock_price *price_history, int idx, const struct date_price *price2check)
+/* days moving average of volume at row idx, as stock_price_sma() */
+uint32_t stock_price_vma(const struct stock_price *price, int idx, int days)
 {
-	int i, low_days;
-	uint32_t max_down_diff = 0;
+	const struct price_sums *sums = &price->sums;
 
-	for (i = low_days = 0; i < 15 && idx < price_history->date_cnt; idx++, i++) {
-		const struct date_price *prev = &price_history->dateprice[idx];
+	if (!price_sums_window(sums, idx, days))
+		return 0;
 
-		if (get_2ndlow(prev) < get_2ndlow(price2check)) {
-			low_days += 1;
-		}
+	return (sums->volume[idx] - sums->volume[idx + days]) / days;
+}
 
-		if (prev->high > price2check->low && prev->high - price2check->low > max_down_diff)
-			max_down_diff = prev->high - price2check->low;
-	}
+/* days money flow index at row idx (x100), as stock_price_sma() */
+uint32_t stock_price_mfi(const struct stock_price *price, int idx, int days)
+{
+	const struct price_sums *sums = &price->sums;
+	uint64_t positive_raw_mf, negative_raw_mf;
 
-	if (low_days > min_sr_candle_nr || (price2check->low && max_down_diff * 1000 / price2check->low < spt_pullback_margin))
+	if (!price_sums_window(sums, idx, days))
 		return 0;
 
-	return 1;
+	positive_raw_mf = sums->positive_mf[idx] - sums->positive_mf[idx + days];
+	negative_raw_mf = sums->negative_mf[idx] - sums->negative_mf[idx + days];
+
+	return 10000 - 1000000 / (100 + (positive_raw_mf * 100 / (negative_raw_mf ? negative_raw_mf : 100)));
 }
 
-static int date_is_uptrend(const struct stock_price *price_history, int idx, const struct date_price *price2check)
+/* one row of the text price format, see fprintf_date_price(). cold may be NULL */
+static int str_to_price(struct csv_row *row, struct date_price *price, struct date_price_cold *cold)
 {
-	int i, low_days;
-	uint32_t max_up_diff = 0;
-	const struct date_price *lowest_date = NULL;
+	struct date_price_cold unused;
+	uint32_t val;
+	int year, month, mday;
+	int i, k;
 
-	for (i = low_days = 0; i < 15 && idx < price_history->date_cnt; idx++, i++) {
-		const struct date_price *prev = &price_history->dateprice[idx];
+	if (csv_next_date(row, &year, &month, &mday) < 0)
+		return -1;
+	price->date = year * 10000 + month * 100 + mday;
 
-		if (get_2ndhigh(prev) > get_2ndhigh(price2check))
-			low_days += 1;
+	if (!cold)
+		cold = &unused;
 
-		if (prev->low < price2check->high && price2check->high - prev->low > max_up_diff) {
-			max_up_diff = price2check->high - prev->low;
-			lowest_date = prev;
+	if (csv_next_uint(row, &val) < 0)
+		return -1;
+	cold->wday = val;
+
+	if (csv_next_uint(row, &price->open) < 0
+	    || csv_next_uint(row, &price->high) < 0
+	    || csv_next_uint(row, &price->low) < 0
+	    || csv_next_uint(row, &price->close) < 0
+	    || csv_next_uint(row, &price->volume) < 0)
+		return -1;
+
+	for (k = 0; k < indicator_nr; k++) {
+		uint32_t *value = indicator_value(&indicators[k], price);
+
+		for (i = 0; i < indicators[k].column_nr; i++) {
+			if (csv_next_uint(row, &value[i]) < 0)
+				return -1;
 		}
 	}
 
-	if (low_days > min_sr_candle_nr || !lowest_date || (max_up_diff * 1000 / get_2ndlow(lowest_date) < bo_sr_height_margin))
-		return 0;
+	if (csv_next_uint(row, &val) < 0)
+		return -1;
+	price->candle_color = val;
 
-	return 1;
+	if (csv_next_uint(row, &val) < 0)
+		return -1;
+	price->candle_trend = val;
+
+	if (csv_next_uint(row, &val) < 0)
+		return -1;
+	price->sr_flag = val;
+
+	if (csv_next_uint(row, &cold->height_low_spt) < 0
+	    || csv_next_uint(row, &cold->height_2ndlow_spt) < 0
+	    || csv_next_uint(row, &cold->height_high_rst) < 0
+	    || csv_next_uint(row, &cold->height_2ndhigh_rst) < 0)
+		return -1;
+
+	return 0;
 }
 
-static void check_support(const struct stock_price *price_history, const struct date_price *price2check, struct stock_support *sspt)
+int stock_price_history_from_file(const char *fname, struct stock_price *price)
 {
-	const struct date_price *yesterday = NULL;
-	const struct date_price *lowest_date = price2check;
-	int i;
+	FILE *fp;
+	char buf[1024];
+	int line_nr = 0;
+	int rt;
 
-	sspt->date_nr = 0;
+	if (!fname || !fname[0] || !price) {
+		anna_error("invalid input parameters\n");
+		return -1;
+	}
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		uint32_t price2check_2ndlow = get_2ndlow(price2check);
+	price->date_cnt = 0;
 
-		if (strcmp(price2check->date, prev->date) <= 0)
-			continue;
+	rt = price_file_read(fname, price);
+	if (rt <= 0)
+		return rt;
 
-		if (yesterday == NULL) {
-			yesterday = prev;
+	/* legacy text format, see 'anna convert' */
+	fp = fopen(fname, "r");
+	if (!fp) {
+		anna_error("fopen(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
 
-			if (!date_is_downtrend(price_history, i, price2check))
-				break;
+	price->sector[0] = 0;
 
-			if (sma2check != -1 && yesterday->sma[sma2check] != 0) {
-				if (!sma_hit(price2check->low, yesterday->sma[sma2check])
-				    && !sma_hit(price2check_2ndlow, yesterday->sma[sma2check]))
-				{
-					break;
-				}
-			}
-		}
+	while (fgets(buf, sizeof(buf), fp)) {
+		struct csv_row row;
 
-		if (prev->low < lowest_date->low)
-			lowest_date = prev;
+		line_nr += 1;
 
-		int datecnt = i + 1;
-		uint32_t prev_2ndhigh = get_2ndhigh(prev);
-		uint32_t prev_2ndlow = get_2ndlow(prev);
+		if (buf[0] == '#')
+			continue;
 
-		if ((prev->sr_flag & SR_F_SUPPORT_LOW)
-		    && sr_height_margin_datecnt(prev->height_low_spt, prev_2ndlow, datecnt))
-		{
-			if (sr_hit(price2check->low, prev->low) || sr_hit(price2check_2ndlow, prev->low)) {
-				int8_t is_db = lowest_date == prev || lowest_date == price2check;
-				date2sspt_copy(prev, sspt, is_db);
-				continue;
-			}
+		if (buf[0] == '%') {
+			buf[strlen(buf) - 1] = 0;
+			if (strncmp(&buf[1], "sector=", strlen("sector=")) == 0)
+				strlcpy(price->sector, strchr(buf, '=') + 1, sizeof(price->sector));
+			continue;
 		}
 
-		if ((prev->sr_flag & SR_F_SUPPORT_2ndLOW)
-		    && sr_height_margin_datecnt(prev->height_2ndlow_spt, prev_2ndlow, datecnt))
-		{
-			if (sr_hit(price2check->low, prev_2ndlow) || sr_hit(price2check_2ndlow, prev_2ndlow)) {
-				int8_t is_db = lowest_date == prev || lowest_date == price2check;
-				date2sspt_copy(prev, sspt, is_db);
-				continue;
-			}
+		if (stock_price_reserve(price, price->date_cnt + 1) < 0) {
+			fclose(fp);
+			return -1;
 		}
 
-		if ((prev->sr_flag & SR_F_RESIST_HIGH)
-		    && sr_height_margin_datecnt(prev->height_high_rst, prev_2ndhigh, datecnt))
-		{
-			if (sr_hit(price2check->low, prev->high) || sr_hit(price2check_2ndlow, prev->high)) {
-				date2sspt_copy(prev, sspt, 0);
-				continue;
-			}
-		}
+		csv_row_init(&row, fname, line_nr, buf);
 
-		if ((prev->sr_flag & SR_F_RESIST_2ndHIGH)
-		    && sr_height_margin_datecnt(prev->height_2ndhigh_rst, prev_2ndhigh, datecnt))
-		{
-			if (sr_hit(price2check->low, prev_2ndhigh) || sr_hit(price2check_2ndlow, prev_2ndhigh)) {
-				date2sspt_copy(prev, sspt, 0);
-				continue;
-			}
+		if (str_to_price(&row, &price->dateprice[price->date_cnt], &price->cold[price->date_cnt]) < 0) {
+			csv_error(&row, "malformed price, skipped\n");
+			continue;
 		}
+
+		price->date_cnt += 1;
 	}
+
+	fclose(fp);
+
+	return 0;
 }
 
-static int is_strong_up(const struct stock_price *price_history, const struct date_price *price2check, const struct date_price *prev)
+/* zero-copy load if possible, price must be released by stock_price_free() */
+int stock_price_map_file(const char *fname, struct stock_price *price)
 {
-	const struct date_price *past;
-	int i;
+	int rt = price_file_map(fname, price);
 
-	if (price2check->candle_trend == CANDLE_TREND_BEAR)
-		return 0;
+	if (rt <= 0)
+		return rt;
 
-	if (!prev) {
-		for (i = 0; i < price_history->date_cnt; i++) {
-			prev = &price_history->dateprice[i];
+	return stock_price_history_from_file(fname, price);
+}
 
-			if (strcmp(price2check->date, prev->date) <= 0)
-				continue;
-			break;
-		}
+int stock_price_realtime_from_file(const char *output_fname, struct date_price *price)
+{
+	struct csv_row row;
+	char buf[1024];
+	int rt = -1;
 
-		if (i == price_history->date_cnt)
-			return 0;
+	FILE *fp = fopen(output_fname, "r");
+	if (!fp) {
+		anna_error("fopen(%s) failed: %d(%s)\n", output_fname, errno, strerror(errno));
+		return -1;
 	}
 
-	int body_size = price2check->close - price2check->open;
-	body_size = ((int64_t)body_size) * 1000 / price2check->open;
-	int vma10d_inc = prev->vma[VMA_10d] ? price2check->volume * 100 / prev->vma[VMA_10d] : 0;
-	int vma20d_inc = prev->vma[VMA_20d] ? price2check->volume * 100 / prev->vma[VMA_20d] : 0;
+	if (!fgets(buf, sizeof(buf), fp)) {
+		anna_error("fgets(%s) failed: %d(%s)\n", output_fname, errno, strerror(errno));
+		goto finish;
+	}
 
-	if (vma20d_inc >= 200 || vma20d_inc >= 200)
-		return 1;
+	/* no quote, e.g. N/A */
+	if (!isdigit(buf[0]))
+		goto finish;
 
-	if (body_size >= 20 && (vma10d_inc >= 120 || vma20d_inc >= 120))
-		return 1;
+	csv_row_init(&row, output_fname, 1, buf);
 
-	if (price2check->close > get_2ndlow(prev) && price2check->volume > prev->volume)
-		return 1;
+	if (csv_next_price(&row, &price->open) < 0
+	    || csv_next_price(&row, &price->high) < 0
+	    || csv_next_price(&row, &price->low) < 0
+	    || csv_next_price(&row, &price->close) < 0
+	    || csv_next_uint(&row, &price->volume) < 0)
+	{
+		csv_error(&row, "malformed quote\n");
+		goto finish;
+	}
 
-	if (price2check->close > prev->high && (vma10d_inc >= 100 || vma20d_inc >= 100))
-		return 1;
+	calculate_candle_stats(price, 1);
 
-	for (i = 0, past = prev; i < 5; i++, past = past - 1) {
-		if (price2check->volume < past->volume)
-			break;
-	}
+	rt = 0;
 
-	if (i == 5)
-		return 1;
+finish:
+	fclose(fp);
 
-	return 0;
+	return rt;
 }
 
-static void check_breakout(const struct stock_price *price_history, const struct date_price *price2check, struct stock_support *sspt, int strong)
+/*
+ * "yyyy-mm-dd" to yyyymmdd in *date, 0 for an empty str or "realtime",
+ * i.e. the latest price. returns -1 if str is not such a date.
+ */
+int stock_date_from_str(const char *str, uint32_t *date)
 {
-	const struct date_price *yesterday = NULL;
-	int i;
-
-	sspt->date_nr = 0;
-	sspt->avg_spt_price = 0;
+	unsigned int year, month, mday;
+	int len = 0;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
+	*date = 0;
 
-		if (strcmp(price2check->date, prev->date) <= 0)
-			continue;
+	if (!str || !str[0] || strcmp(str, "realtime") == 0)
+		return 0;
 
-		if (yesterday == NULL) {
-			yesterday = prev;
-			if (!date_is_uptrend(price_history, i, price2check))
-				break;
+	if (sscanf(str, "%4u-%2u-%2u%n", &year, &month, &mday, &len) != 3 || len != 10 || str[len]
+	    || !isdigit(str[0]) || !isdigit(str[5]) || !isdigit(str[8])
+	    || month < 1 || month > 12 || mday < 1 || mday > 31)
+		return -1;
 
-			if (strong && !is_strong_up(NULL, price2check, prev))
-				break;
-		}
+	*date = year * 10000 + month * 100 + mday;
 
-		int datecnt = i + 1;
-		uint32_t prev_2ndhigh = get_2ndhigh(prev);
-		uint32_t prev_2ndlow = get_2ndlow(prev);
+	return 0;
+}
 
-		if ((prev->sr_flag & SR_F_SUPPORT_LOW)
-		    && price2check->close > prev->low
-		    && yesterday->close <= prev->low
-		    && sr_height_margin_datecnt(prev->height_low_spt, prev_2ndlow, datecnt))
-		{
-			if (bo_hit(price2check->close, prev->low)) {
-				date2sspt_copy(prev, sspt, 0);
-				sspt->avg_spt_price += (prev->low + prev_2ndlow) >> 1;
-				continue;
-			}
-		}
+static int dayofweek(int year, int month, int mday)
+{
+	static int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+	year -= month < 3;
+	return ( year + year/4 - year/100 + year/400 + t[month-1] + mday) % 7;
+}
 
-		if ((prev->sr_flag & SR_F_SUPPORT_2ndLOW)
-		    && price2check->close > prev_2ndlow
-		    && yesterday->close <= prev_2ndlow
-		    && sr_height_margin_datecnt(prev->height_2ndlow_spt, prev_2ndlow, datecnt))
-		{
-			if (bo_hit(price2check->close, prev_2ndlow)) {
-				date2sspt_copy(prev, sspt, 0);
-				sspt->avg_spt_price += (prev->low + prev_2ndlow) >> 1;
-				continue;
-			}
-		}
+int stock_price_from_file(const char *fname, struct stock_price *price)
+{
+	const char *line, *eol;
+	char *buf = NULL;
+	struct stat st;
+	int line_nr = 1, row_nr = 0;
+	int fd = -1;
+	int rt = -1;
 
-		if ((prev->sr_flag & SR_F_RESIST_HIGH)
-		    && price2check->close > prev->high
-		    && yesterday->close <= prev->high
-		    && sr_height_margin_datecnt(prev->height_high_rst, prev_2ndhigh, datecnt))
-		{
-			if (bo_hit(price2check->close, prev->high)) {
-				date2sspt_copy(prev, sspt, 0);
-				sspt->avg_spt_price += (prev->high + prev_2ndhigh) >> 1;
-				continue;
-			}
-		}
+	if (!fname || !fname[0] || !price) {
+		anna_error("invalid input parameters\n");
+		return -1;
+	}
+
+	price->date_cnt = 0;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		anna_error("open(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0) {
+		anna_error("fstat(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		goto finish;
+	}
+
+	/* the whole file is read at once and tokenized in place, NUL terminated */
+	buf = malloc(st.st_size + 1);
+	if (!buf) {
+		anna_error("malloc(%ld) failed\n", (long)st.st_size);
+		goto finish;
+	}
+
+	if (read_full(fd, buf, st.st_size) < 0) {
+		anna_error("read(%s) failed: %d(%s)\n", fname, errno, strerror(errno));
+		goto finish;
+	}
+	buf[st.st_size] = 0;
+
+	/* one row per line after the 1st, the rows are sized before they are parsed */
+	for (line = buf; (eol = memchr(line, '\n', buf + st.st_size - line)); line = eol + 1)
+		row_nr += 1;
+
+	if (stock_price_reserve(price, row_nr) < 0)
+		goto finish;
 
-		if ((prev->sr_flag & SR_F_RESIST_2ndHIGH)
-		    && price2check->close > prev_2ndhigh
-		    && yesterday->close <= prev_2ndhigh
-		    && sr_height_margin_datecnt(prev->height_2ndhigh_rst, prev_2ndhigh, datecnt))
+	for (line = strchr(buf, '\n'); line && *++line; line = strchr(line, '\n')) {
+		struct date_price *cur = &price->dateprice[price->date_cnt];
+		struct date_price_cold *cold = &price->cold[price->date_cnt];
+		struct csv_row row;
+		uint32_t  adj_close;
+		int year, month, mday;
+
+		line_nr += 1;
+
+		/* the buffer may hold an earlier symbol's rows, sr_flag is or'ed into */
+		memset(cur, 0, sizeof(*cur));
+		memset(cold, 0, sizeof(*cold));
+
+		csv_row_init(&row, fname, line_nr, line);
+
+		/* date,open,high,low,close,volume[,adj_close], e.g. yahoo's "null" rows are dropped */
+		if (csv_next_date(&row, &year, &month, &mday) < 0
+		    || csv_next_price(&row, &cur->open) < 0
+		    || csv_next_price(&row, &cur->high) < 0
+		    || csv_next_price(&row, &cur->low) < 0
+		    || csv_next_price(&row, &cur->close) < 0
+		    || csv_next_uint(&row, &cur->volume) < 0)
 		{
-			if (bo_hit(price2check->close, prev_2ndhigh)) {
-				date2sspt_copy(prev, sspt, 0);
-				sspt->avg_spt_price += (prev->high + prev_2ndhigh) >> 1;
-				continue;
-			}
+			csv_error(&row, "malformed price, skipped\n");
+			continue;
 		}
-	}
 
-	if (sspt->date_nr)
-		sspt->avg_spt_price /= sspt->date_nr;
-}
+		cur->date = year * 10000 + month * 100 + mday;
+		cold->wday = dayofweek(year, month, mday);
 
-static int get_today_price(const char *symbol, struct date_price *price)
-{
-	char fname[128];
-	char buf[1024];
-	FILE *fp;
-	int rt = -1;
+		if (fetch_source == FETCH_SOURCE_GOOGLE)
+			goto next_date;
 
-	snprintf(fname, sizeof(fname), ROOT_DIR "/tmp/%s_today.price", symbol);
+		if (csv_next_price(&row, &adj_close) < 0) {
+			csv_error(&row, "malformed adj_close, skipped\n");
+			continue;
+		}
 
-	fp = fopen(fname, "r");
-	if (!fp)
-		return -1;
+		if (cur->close != adj_close) {
+			uint32_t diff = cur->close > adj_close ? cur->close - adj_close : adj_close - cur->close;
 
-	fgets(buf, sizeof(buf), fp);
+			if (diff * 100 / cur->close > 5) {
+				cur->open = ((uint64_t)cur->open) * adj_close / cur->close;
+				cur->high = ((uint64_t)cur->high) * adj_close /cur->close;
+				cur->low = ((uint64_t)cur->low) * adj_close / cur->close;
+				cur->close = adj_close;
+			}
+		}
+next_date:
+		price->date_cnt += 1;
+	}
 
-	if (str_to_price(buf, price) < 0)
-		goto finish;
+	if (price->date_cnt > 20)
+		calculate_stock_price_statistics(price);
 
 	rt = 0;
 
 finish:
-	fclose(fp);
+	free(buf);
+	if (fd >= 0)
+		close(fd);
 
 	return rt;
 }
 
-static int get_stock_price2check(const char *symbol, const char *date,
-				const struct stock_price *price_history,
-				struct date_price *price2check)
+/* cold may be NULL, e.g. for a realtime price, its fields are written as 0 */
+void fprintf_date_price(FILE *fp, const struct date_price *p, const struct date_price_cold *cold)
 {
-	if (date && date[0]) {
-		int i;
+	static const struct date_price_cold none;
+	int i, k;
 
-		for (i = 0; i < price_history->date_cnt; i++) {
-			const struct date_price *cur = &price_history->dateprice[i];
-			if (!strcmp(cur->date, date)) {
-				memcpy(price2check, cur, sizeof(*price2check));
-				break;
-			}
-		}
+	if (!cold)
+		cold = &none;
 
-		if (i == price_history->date_cnt) {
-			//anna_error("date='%s' is  not found in history price\n", date);
-			return -1;
-		}
-	}
-	else if (get_today_price(symbol, price2check) == 0) {
-		return 0;
-	}
-	else if (!date || !date[0]) {
-		memcpy(price2check, &price_history->dateprice[0], sizeof(*price2check));
+	fprintf(fp, DATE_FMT ",%u,%u,%u,%u,%u,%u,", /* date, wday, open, high, low, close, volume */
+		DATE_ARG(p->date), cold->wday, p->open, p->high, p->low, p->close, p->volume);
+
+	for (k = 0; k < indicator_nr; k++) {
+		const uint32_t *value = indicator_value(&indicators[k], p);
+
+		for (i = 0; i < indicators[k].column_nr; i++)
+			fprintf(fp, "%u,", value[i]);
 	}
 
-	return 0;
+	fprintf(fp, "%u,%u,%u,%u,%u,%u,%u\n",
+		p->candle_color, p->candle_trend, p->sr_flag,
+		cold->height_low_spt, cold->height_2ndlow_spt, cold->height_high_rst, cold->height_2ndhigh_rst);
 }
 
-static int get_symbol_price_for_check(const char *symbol, const char *date, const char *fname,
-					struct stock_price *price_history, struct date_price *price2check)
+static void fprintf_stock_price(FILE *fp, const char *sector, const struct stock_price *price)
 {
-	if (stock_price_history_from_file(fname, price_history) < 0) {
-		anna_error("stock_price_history_from_file(%s) failed\n", fname);
-		return -1;
+	int i, k;
+
+	if (sector && sector[0])
+		fprintf(fp, "%%sector=%s\n", sector);
+
+	fprintf(fp, "# date,wday, open, high, low, close, volume, ");
+
+	for (k = 0; k < indicator_nr; k++) {
+		for (i = 0; i < indicators[k].column_nr; i++)
+			fprintf(fp, "%s, ", indicators[k].column[i]);
 	}
 
-	if (get_stock_price2check(symbol, date, price_history, price2check) < 0) {
-		//anna_error("%s: get_stock_price2check(%s)\n", symbol, date);
-		return -1;
+	fprintf(fp, "candle_color, candle_trend, sr_flag, height_low_spt,2ndlow_spt,high_rst,2ndhigh_rst\n");
+
+	for (i = 0; i < price->date_cnt; i++) {
+		fprintf_date_price(fp, &price->dateprice[i], &price->cold[i]);
 	}
+}
 
-	return 0;
+int stock_price_stored(const struct price_store *store, const char *symbol)
+{
+	char fname[256];
+
+	if (store->db)
+		return price_db_has_symbol(store->db, symbol);
+
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s/%s.price", store->group, symbol);
+
+	return access(fname, F_OK) == 0;
 }
 
-static void get_250d_high_low(const struct stock_price *price_history, const struct date_price *price2check,
-				uint32_t *high, uint32_t *low)
+int stock_price_to_file(const struct price_store *store, const char *sector, const char *symbol, const struct stock_price *price)
 {
-	int i, j;
+	char output_fname[256];
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) <= 0)
-			continue;
+	if (store->db)
+		return price_db_write(store->db, symbol, sector, price);
 
-		*high = price2check->high;
-		*low = price2check->low;
+	snprintf(output_fname, sizeof(output_fname), ROOT_DIR "/%s/%s.price", store->group, symbol);
 
-		for (j = i; j < 250 && j < price_history->date_cnt; j++) {
-			prev = &price_history->dateprice[j];
-			if (prev->high > *high)
-				*high = prev->high;
-			if (prev->low < *low)
-				*low = prev->low;
-		}
+	return price_file_write(output_fname, sector, price);
+}
 
-		break;
-	}
+/* write back the row_nr latest rows of price, a price file is rewritten as a whole */
+int stock_price_rows_to_file(const struct price_store *store, const char *sector, const char *symbol,
+			     const struct stock_price *price, int row_nr)
+{
+	if (store->db)
+		return price_db_write_rows(store->db, symbol, sector, price, row_nr);
+
+	return stock_price_to_file(store, sector, symbol, price);
 }
 
-static const char * get_price_volume_change(const struct stock_price *price_history, const struct date_price *price2check)
+/* load symbol's stored price into a writable buffer */
+int stock_price_load(const struct price_store *store, const char *symbol, struct stock_price *price)
 {
-	static char output_str[256];
-	const struct date_price *yesterday = NULL;
-	uint32_t yesterday_2ndhigh;
-	int is_up = 0, price_change = 0, vma20d_percent = 0;
-	int price_larger_days = 0, count_price = 1, is_first_new_high = 0;
-	int volume_larger_days = 0, count_volume = 1;
-	int up_tail_percent = 0, body_percent = 0, down_tail_percent = 0, body_size = 0;
-	int i;
+	char fname[256];
 
-	output_str[0] = 0;
+	if (store->db)
+		return price_db_read(store->db, symbol, price);
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) > 0) {
-			yesterday = prev;
-			break;
-		}
-	}
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s/%s.price", store->group, symbol);
 
-	if (!yesterday)
-		return "N/A";
+	return stock_price_history_from_file(fname, price);
+}
 
-	yesterday_2ndhigh = get_2ndhigh(yesterday);
+/* symbol's stored price, mapped read-only if it's in a current price file */
+int stock_price_open(const struct price_store *store, const char *symbol, struct stock_price *price)
+{
+	char fname[256];
 
-	for ( ; i < price_history->date_cnt && i < 250 && (count_volume || count_price); i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (prev->volume == 0)
-			continue;
+	if (store->db)
+		return price_db_read(store->db, symbol, price);
 
-		if (count_volume) {
-			if (price2check->volume > prev->volume)
-				volume_larger_days += 1;
-			else if (price2check->volume < prev->volume)
-				count_volume = 0;
-		}
+	snprintf(fname, sizeof(fname), ROOT_DIR "/%s/%s.price", store->group, symbol);
 
-		if (count_price) {
-			uint32_t prev_2ndhigh = get_2ndhigh(prev);
-			if (get_2ndhigh(price2check) > prev_2ndhigh)
-				price_larger_days += 1;
-			else if (get_2ndhigh(price2check) < prev_2ndhigh)
-				count_price = 0;
-			if (yesterday_2ndhigh < prev_2ndhigh)
-				is_first_new_high = 1;
-		}
-	}
+	return stock_price_map_file(fname, price);
+}
 
-	if (price2check->volume) {
-		if (yesterday->vma[VMA_20d]) {
-			vma20d_percent = (uint64_t)price2check->volume * 1000 / yesterday->vma[VMA_20d];
+void stock_price_dump(const struct price_store *store, int symbols_nr, const char **symbols)
+{
+	char fname[256];
+	struct stock_price price = { };
+	int i;
+
+	for (i = 0; i < symbols_nr; i++) {
+		if (store->db) {
+			if (price_db_read(store->db, symbols[i], &price) < 0)
+				continue;
 		}
-	}
+		else {
+			snprintf(fname, sizeof(fname), ROOT_DIR "/%s/%s.price", store->group, symbols[i]);
 
-	if (price2check->close && yesterday->close) {
-		if (price2check->close >= yesterday->close) {
-			price_change = price2check->close - yesterday->close;
-			is_up = 1;
+			if (stock_price_map_file(fname, &price) < 0)
+				continue;
 		}
-		else
-			price_change = yesterday->close - price2check->close;
 
-		price_change = ((uint64_t)price_change) * 1000 / yesterday->close;
+		fprintf_stock_price(stdout, price.sector, &price);
 	}
 
-	if (price2check->low != price2check->high && price2check->open && price2check->close) {
-		int price_range = price2check->high - price2check->low;
-		int up_tail_range = price2check->high - get_2ndhigh(price2check);
-		int body_range = get_2ndhigh(price2check) - get_2ndlow(price2check);
-		int down_tail_range = get_2ndlow(price2check) - price2check->low;
-		up_tail_percent = up_tail_range * 1000 / price_range;
-		body_percent = body_range * 1000 / price_range;
-		down_tail_percent = down_tail_range * 1000 / price_range;
+	stock_price_free(&price);
+}
 
-                if (price2check->close >= price2check->open)
-                        body_size = price2check->close - price2check->open;
-                else
-                        body_size = price2check->open - price2check->close;
 
-                body_size = ((uint64_t)body_size) * 1000 / price2check->open;
+struct stock_support
+{
+#define STOCK_SUPPORT_MAX_DATES  48
+	uint32_t date[STOCK_SUPPORT_MAX_DATES];
+	uint8_t sr_flag[STOCK_SUPPORT_MAX_DATES];
+	int8_t  is_doublebottom[STOCK_SUPPORT_MAX_DATES];
+	uint32_t  mfi[STOCK_SUPPORT_MAX_DATES];
+	int date_nr;
+	uint32_t avg_spt_price;
+};
+
+static int sr_height_margin_datecnt(const struct check_ctx *ctx, uint64_t height, uint64_t base, int datecnt)
+{
+	return (height * 1000 / base >= ctx->params->sr_height_margin);
+#if 0
+	if (datecnt <= 63) { /* 0 ~ 3 month */
+		return (height * 100 / base >= 4) ? 1 : 0;
+	}
+	else if (datecnt <= 126) { /* 3 ~ 6 month */
+		return (height * 100 /base >= 5) ? 1 : 0;
 	}
+	else if (datecnt <= 252) { /* 6 month ~ 1 year */
+		return (height * 100 /base >= 6) ? 1 : 0;
+	}
+	else { /* > 1 year */
+		return (height * 100 / base >= 8) ? 1 : 0;
+	}
+#endif
+}
 
-	snprintf(output_str, sizeof(output_str),
-		"price(%d.%03d > %d days, %s%c%d.%d%%, color=%s/trend=%s(%d.%d/%d.%d/%d.%d), body_size=%d.%d%%, volume(%d > %s%d%s days, vma20d=%s%d.%d%%%s)",
-		price2check->close / 1000, price2check->close % 1000, price_larger_days, (price_larger_days >= 200 && is_first_new_high) ? "1st_new_high, " : "",
-		is_up ? '+' : '-', price_change / 10, price_change % 10,
-		candle_color[price2check->candle_color], candle_trend[price2check->candle_trend],
-		up_tail_percent / 10, up_tail_percent % 10, body_percent / 10, body_percent % 10, down_tail_percent / 10, down_tail_percent % 10,
-		body_size / 10, body_size % 10,
-		price2check->volume, volume_larger_days >= 5 ? ANSI_COLOR_YELLOW : "", volume_larger_days, volume_larger_days >= 5 ? ANSI_COLOR_RESET : "",
-		vma20d_percent >= 1000 ? ANSI_COLOR_YELLOW : "", vma20d_percent / 10, vma20d_percent % 10, vma20d_percent >= 1000 ? ANSI_COLOR_RESET : "");
+static int sr_hit(uint64_t price2check, uint64_t base_price)
+{
+	uint64_t diff = price2check > base_price ? price2check - base_price : base_price - price2check;
+	return (diff * 1000 / base_price <= 15);
+}
+
+static int sma_hit(uint64_t price2check, uint64_t sma_price)
+{
+	uint64_t diff = price2check > sma_price ? price2check - sma_price : sma_price - price2check;
+	return (diff * 1000 / sma_price <= 10);
+}
+
+static int bo_hit(uint64_t price2check, uint64_t base_price)
+{
+	uint64_t diff = price2check > base_price ? price2check - base_price : base_price - price2check;
+	return (diff * 1000 / base_price >= 20);
+}
+
+static void date2sspt_copy(const struct date_price *prev, struct stock_support *sspt, int8_t is_db)
+{
+	if (sspt->date_nr >= STOCK_SUPPORT_MAX_DATES)
+		return;
+
+	sspt->date[sspt->date_nr] = prev->date;
+	sspt->sr_flag[sspt->date_nr] = prev->sr_flag;
+	sspt->is_doublebottom[sspt->date_nr] = is_db;
+	sspt->mfi[sspt->date_nr] = prev->mfi;
+	sspt->date_nr += 1;
+}
+
+static int date_is_downtrend(const struct check_ctx *ctx, const struct stock_price *price_history, int idx, const struct date_price *price2check)
+{
+	int i, low_days;
+	uint32_t max_down_diff = 0;
+
+	for (i = low_days = 0; i < 15 && idx < price_history->date_cnt; idx++, i++) {
+		const struct date_price *prev = &price_history->dateprice[idx];
+
+		if (get_2ndlow(prev) < get_2ndlow(price2check)) {
+			low_days += 1;
+		}
+
+		if (prev->high > price2check->low && prev->high - price2check->low > max_down_diff)
+			max_down_diff = prev->high - price2check->low;
+	}
+
+	if (low_days > min_sr_candle_nr || (price2check->low && max_down_diff * 1000 / price2check->low < ctx->params->spt_pullback_margin))
+		return 0;
+
+	return 1;
+}
+
+static int date_is_uptrend(const struct check_ctx *ctx, const struct stock_price *price_history, int idx, const struct date_price *price2check)
+{
+	int i, low_days;
+	uint32_t max_up_diff = 0;
+	const struct date_price *lowest_date = NULL;
+
+	for (i = low_days = 0; i < 15 && idx < price_history->date_cnt; idx++, i++) {
+		const struct date_price *prev = &price_history->dateprice[idx];
+
+		if (get_2ndhigh(prev) > get_2ndhigh(price2check))
+			low_days += 1;
+
+		if (prev->low < price2check->high && price2check->high - prev->low > max_up_diff) {
+			max_up_diff = price2check->high - prev->low;
+			lowest_date = prev;
+		}
+	}
+
+	if (low_days > min_sr_candle_nr || !lowest_date || (max_up_diff * 1000 / get_2ndlow(lowest_date) < ctx->params->bo_sr_height_margin))
+		return 0;
+
+	return 1;
+}
+
+/* order of the levels of a check: by row, a row's SR_F_xxx in the order they are tested */
+static int level_row_cmp(const void *a, const void *b)
+{
+	const struct price_level *l1 = *(const struct price_level **)a, *l2 = *(const struct price_level **)b;
+
+	if (l1->row != l2->row)
+		return l1->row - l2->row;
+
+	return l1->sr_flag - l2->sr_flag;
+}
+
+/*
+ * the levels from level_nr, as found by stock_price_level_find(), that
+ * match(level, arg) and are not older than row yesterday_idx; sorted by
+ * level_row_cmp(), to be freed by the caller. NULL if there are none.
+ */
+static const struct price_level **match_levels(const struct check_ctx *ctx, const struct stock_price *price_history, int yesterday_idx,
+					       const int (*level_ranges)[2], int range_nr,
+					       int (*match)(const struct check_ctx *, const struct stock_price *,
+							    const struct price_level *, const void *),
+					       const void *arg, int *match_nr)
+{
+	const struct price_level **matched;
+	int i, k, nr = 0;
+
+	*match_nr = 0;
+
+	for (k = 0; k < range_nr; k++)
+		nr += level_ranges[k][1] - level_ranges[k][0];
+
+	if (!nr)
+		return NULL;
+
+	matched = malloc(sizeof(*matched) * nr);
+	if (!matched) {
+		anna_error("malloc(%zu) failed\n", sizeof(*matched) * nr);
+		return NULL;
+	}
+
+	nr = 0;
+
+	for (k = 0; k < range_nr; k++) {
+		for (i = level_ranges[k][0]; i < level_ranges[k][1]; i++) {
+			const struct price_level *level = &price_history->levels.level[i];
+
+			/* in an earlier range too */
+			if (k && i >= level_ranges[0][0] && i < level_ranges[0][1])
+				continue;
+
+			if (level->row >= yesterday_idx && match(ctx, price_history, level, arg))
+				matched[nr++] = level;
+		}
+	}
+
+	qsort(matched, nr, sizeof(*matched), level_row_cmp);
+
+	*match_nr = nr;
+
+	return matched;
+}
+
+/* the levels sr_hit() may take for price, from which level_ranges[] is searched */
+static void sr_hit_range(const struct stock_price *price_history, uint32_t price, int *range)
+{
+	range[0] = stock_price_level_find(price_history, (uint64_t)price * 1000 / 1016);
+	range[1] = stock_price_level_find(price_history, (uint64_t)price * 1000 / 984 + 1);
+}
+
+static int level_height_margin(const struct check_ctx *ctx, const struct stock_price *price_history, const struct price_level *level)
+{
+	const struct date_price *row = &price_history->dateprice[level->row];
+	uint32_t base = is_support(level->sr_flag) ? get_2ndlow(row) : get_2ndhigh(row);
+
+	return sr_height_margin_datecnt(ctx, level->height, base, level->row + 1);
+}
+
+static int level_is_support(const struct check_ctx *ctx, const struct stock_price *price_history, const struct price_level *level, const void *arg)
+{
+	const struct date_price *price2check = arg;
+
+	return level_height_margin(ctx, price_history, level)
+	       && (sr_hit(price2check->low, level->price) || sr_hit(get_2ndlow(price2check), level->price));
+}
+
+static void check_support(const struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *price2check, int yesterday_idx,
+			  struct stock_support *sspt)
+{
+	const struct date_price *yesterday;
+	const struct price_level **matched;
+	uint32_t price2check_2ndlow = get_2ndlow(price2check);
+	int level_ranges[2][2];
+	int i, match_nr;
+
+	sspt->date_nr = 0;
+
+	if (yesterday_idx == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[yesterday_idx];
+
+	if (!date_is_downtrend(ctx, price_history, yesterday_idx, price2check))
+		return;
+
+	if (ctx->sma2check && sma2check_at(ctx, price_history, yesterday) != 0) {
+		if (!sma_hit(price2check->low, sma2check_at(ctx, price_history, yesterday))
+		    && !sma_hit(price2check_2ndlow, sma2check_at(ctx, price_history, yesterday)))
+		{
+			return;
+		}
+	}
+
+	/* only the levels near price2check's low or 2ndlow can be hit */
+	sr_hit_range(price_history, price2check->low, level_ranges[0]);
+	sr_hit_range(price_history, price2check_2ndlow, level_ranges[1]);
+
+	matched = match_levels(ctx, price_history, yesterday_idx, level_ranges, 2, level_is_support, price2check, &match_nr);
+
+	for (i = 0; i < match_nr; i++) {
+		const struct price_level *level = matched[i];
+		const struct date_price *prev = &price_history->dateprice[level->row];
+		int8_t is_db = 0;
+
+		/* a row is taken once, by the first of its levels */
+		if (i && matched[i - 1]->row == level->row)
+			continue;
+
+		/* prev is the first lowest row since price2check, or none is below price2check */
+		if (is_support(level->sr_flag)) {
+			uint32_t lowest = stock_price_range(price_history, PRICE_RANGE_LOW, yesterday_idx, level->row - yesterday_idx);
+
+			is_db = prev->low < lowest && prev->low < price2check->low;
+			is_db |= price2check->low <= lowest && price2check->low <= prev->low;
+		}
+
+		date2sspt_copy(prev, sspt, is_db);
+	}
+
+	free(matched);
+}
+
+/* prev is the day before price2check */
+static int is_strong_up(const struct date_price *price2check, const struct date_price *prev)
+{
+	const struct date_price *past;
+	int i;
+
+	if (price2check->candle_trend == CANDLE_TREND_BEAR)
+		return 0;
+
+	int body_size = price2check->close - price2check->open;
+	body_size = ((int64_t)body_size) * 1000 / price2check->open;
+	int vma10d_inc = prev->vma[VMA_10d] ? price2check->volume * 100 / prev->vma[VMA_10d] : 0;
+	int vma20d_inc = prev->vma[VMA_20d] ? price2check->volume * 100 / prev->vma[VMA_20d] : 0;
+
+	if (vma20d_inc >= 200 || vma20d_inc >= 200)
+		return 1;
+
+	if (body_size >= 20 && (vma10d_inc >= 120 || vma20d_inc >= 120))
+		return 1;
+
+	if (price2check->close > get_2ndlow(prev) && price2check->volume > prev->volume)
+		return 1;
+
+	if (price2check->close > prev->high && (vma10d_inc >= 100 || vma20d_inc >= 100))
+		return 1;
+
+	for (i = 0, past = prev; i < 5; i++, past = past - 1) {
+		if (price2check->volume < past->volume)
+			break;
+	}
+
+	if (i == 5)
+		return 1;
+
+	return 0;
+}
+
+static int level_is_breakout(const struct check_ctx *ctx, const struct stock_price *price_history, const struct price_level *level, const void *arg)
+{
+	const struct date_price *price2check = arg;
+
+	return level_height_margin(ctx, price_history, level) && bo_hit(price2check->close, level->price);
+}
+
+static void check_breakout(const struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *price2check, int yesterday_idx,
+			   struct stock_support *sspt, int strong)
+{
+	const struct date_price *yesterday;
+	const struct price_level **matched;
+	int level_ranges[1][2];
+	int i, match_nr;
+
+	sspt->date_nr = 0;
+	sspt->avg_spt_price = 0;
+
+	if (yesterday_idx == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[yesterday_idx];
+
+	if (!date_is_uptrend(ctx, price_history, yesterday_idx, price2check))
+		return;
+
+	if (strong && !is_strong_up(price2check, yesterday))
+		return;
+
+	/* the levels crossed from yesterday's close up to price2check's */
+	if (price2check->close <= yesterday->close)
+		return;
+
+	level_ranges[0][0] = stock_price_level_find(price_history, yesterday->close);
+	level_ranges[0][1] = stock_price_level_find(price_history, price2check->close);
+
+	matched = match_levels(ctx, price_history, yesterday_idx, level_ranges, 1, level_is_breakout, price2check, &match_nr);
+
+	for (i = 0; i < match_nr; i++) {
+		const struct price_level *level = matched[i];
+		const struct date_price *prev = &price_history->dateprice[level->row];
+
+		if (i && matched[i - 1]->row == level->row)
+			continue;
+
+		date2sspt_copy(prev, sspt, 0);
+
+		if (is_support(level->sr_flag))
+			sspt->avg_spt_price += (prev->low + get_2ndlow(prev)) >> 1;
+		else
+			sspt->avg_spt_price += (prev->high + get_2ndhigh(prev)) >> 1;
+	}
+
+	free(matched);
+
+	if (sspt->date_nr)
+		sspt->avg_spt_price /= sspt->date_nr;
+}
+
+static int get_today_price(const char *symbol, struct date_price *price)
+{
+	struct csv_row row;
+	char fname[128];
+	char buf[1024];
+	FILE *fp;
+	int rt = -1;
+
+	snprintf(fname, sizeof(fname), ROOT_DIR "/tmp/%s_today.price", symbol);
+
+	fp = fopen(fname, "r");
+	if (!fp)
+		return -1;
+
+	if (!fgets(buf, sizeof(buf), fp))
+		goto finish;
+
+	csv_row_init(&row, fname, 1, buf);
+
+	if (str_to_price(&row, price, NULL) < 0) {
+		csv_error(&row, "malformed price\n");
+		goto finish;
+	}
+
+	rt = 0;
+
+finish:
+	fclose(fp);
+
+	return rt;
+}
+
+/*
+ * date is yyyymmdd, 0 for today's price. returns the row of the day before
+ * price2check (date_cnt if there is none) so that no check has to search
+ * for it, -1 if date is not in the history.
+ */
+static int get_stock_price2check(const char *symbol, uint32_t date,
+				const struct stock_price *price_history,
+				struct date_price *price2check)
+{
+	int i;
+
+	if (date) {
+		i = stock_price_date_before(price_history, date + 1);
+		if (i == price_history->date_cnt || price_history->dateprice[i].date != date) {
+			//anna_error("date=%u is  not found in history price\n", date);
+			return -1;
+		}
+
+		memcpy(price2check, &price_history->dateprice[i], sizeof(*price2check));
+	}
+	else if (get_today_price(symbol, price2check) == 0) {
+		return stock_price_date_before(price_history, price2check->date);
+	}
+	else {
+		memcpy(price2check, &price_history->dateprice[0], sizeof(*price2check));
+		i = 0;
+	}
+
+	return i + 1;
+}
+
+static void get_250d_high_low(const struct stock_price *price_history, const struct date_price *price2check,
+				int yesterday_idx, uint32_t *high, uint32_t *low)
+{
+	int i = yesterday_idx;
+	uint32_t high_250d, low_250d;
+
+	if (i == price_history->date_cnt)
+		return;
+
+	/* up to the 250th latest row */
+	high_250d = stock_price_range(price_history, PRICE_RANGE_HIGH, i, 250 - i);
+	low_250d = stock_price_range(price_history, PRICE_RANGE_LOW, i, 250 - i);
+
+	*high = high_250d > price2check->high ? high_250d : price2check->high;
+	*low = low_250d < price2check->low ? low_250d : price2check->low;
+}
+
+static const char * get_price_volume_change(struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *price2check,
+					     int yesterday_idx)
+{
+	const struct date_price *yesterday = NULL;
+	uint32_t yesterday_2ndhigh;
+	int is_up = 0, price_change = 0, vma20d_percent = 0;
+	int price_larger_days = 0, count_price = 1, is_first_new_high = 0;
+	int volume_larger_days = 0, count_volume = 1;
+	int up_tail_percent = 0, body_percent = 0, down_tail_percent = 0, body_size = 0;
+	int i;
+
+	ctx->change_str[0] = 0;
+
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
+		return "N/A";
+
+	yesterday = &price_history->dateprice[i];
+
+	yesterday_2ndhigh = get_2ndhigh(yesterday);
+
+	for ( ; i < price_history->date_cnt && i < 250 && (count_volume || count_price); i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		if (prev->volume == 0)
+			continue;
+
+		if (count_volume) {
+			if (price2check->volume > prev->volume)
+				volume_larger_days += 1;
+			else if (price2check->volume < prev->volume)
+				count_volume = 0;
+		}
+
+		if (count_price) {
+			uint32_t prev_2ndhigh = get_2ndhigh(prev);
+			if (get_2ndhigh(price2check) > prev_2ndhigh)
+				price_larger_days += 1;
+			else if (get_2ndhigh(price2check) < prev_2ndhigh)
+				count_price = 0;
+			if (yesterday_2ndhigh < prev_2ndhigh)
+				is_first_new_high = 1;
+		}
+	}
+
+	if (price2check->volume) {
+		if (yesterday->vma[VMA_20d]) {
+			vma20d_percent = (uint64_t)price2check->volume * 1000 / yesterday->vma[VMA_20d];
+		}
+	}
+
+	if (price2check->close && yesterday->close) {
+		if (price2check->close >= yesterday->close) {
+			price_change = price2check->close - yesterday->close;
+			is_up = 1;
+		}
+		else
+			price_change = yesterday->close - price2check->close;
+
+		price_change = ((uint64_t)price_change) * 1000 / yesterday->close;
+	}
+
+	if (price2check->low != price2check->high && price2check->open && price2check->close) {
+		int price_range = price2check->high - price2check->low;
+		int up_tail_range = price2check->high - get_2ndhigh(price2check);
+		int body_range = get_2ndhigh(price2check) - get_2ndlow(price2check);
+		int down_tail_range = get_2ndlow(price2check) - price2check->low;
+		up_tail_percent = up_tail_range * 1000 / price_range;
+		body_percent = body_range * 1000 / price_range;
+		down_tail_percent = down_tail_range * 1000 / price_range;
+
+                if (price2check->close >= price2check->open)
+                        body_size = price2check->close - price2check->open;
+                else
+                        body_size = price2check->open - price2check->close;
+
+                body_size = ((uint64_t)body_size) * 1000 / price2check->open;
+	}
+
+	snprintf(ctx->change_str, sizeof(ctx->change_str),
+		"price(%d.%03d > %d days, %s%c%d.%d%%, color=%s/trend=%s(%d.%d/%d.%d/%d.%d), body_size=%d.%d%%, volume(%d > %s%d%s days, vma20d=%s%d.%d%%%s)",
+		price2check->close / 1000, price2check->close % 1000, price_larger_days, (price_larger_days >= 200 && is_first_new_high) ? "1st_new_high, " : "",
+		is_up ? '+' : '-', price_change / 10, price_change % 10,
+		candle_color[price2check->candle_color], candle_trend[price2check->candle_trend],
+		up_tail_percent / 10, up_tail_percent % 10, body_percent / 10, body_percent % 10, down_tail_percent / 10, down_tail_percent % 10,
+		body_size / 10, body_size % 10,
+		price2check->volume, volume_larger_days >= 5 ? ANSI_COLOR_YELLOW : "", volume_larger_days, volume_larger_days >= 5 ? ANSI_COLOR_RESET : "",
+		vma20d_percent >= 1000 ? ANSI_COLOR_YELLOW : "", vma20d_percent / 10, vma20d_percent % 10, vma20d_percent >= 1000 ? ANSI_COLOR_RESET : "");
+
+	return ctx->change_str;
+}
+
+static void symbol_check_support(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx)
+{
+	struct stock_support sspt = { };
+
+	check_support(ctx, price_history, price2check, yesterday_idx, &sspt);
+
+	if (!sspt.date_nr)
+		return;
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; is supported by %d dates:",
+		  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		  DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx), sspt.date_nr);
+
+	check_info(ctx, "%s<sector=%s>%s.\n", ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+/* CANDLE_P_xxx of price2check, the day after row yesterday_idx */
+static uint16_t price2check_patterns(const struct stock_price *price_history, const struct date_price *price2check,
+				     int yesterday_idx)
+{
+	int prev_nr = price_history->date_cnt - yesterday_idx;
+
+	if (prev_nr <= 0)
+		return 0;
+
+	return candle_pattern(price2check, &price_history->dateprice[yesterday_idx], prev_nr > 3 ? 3 : prev_nr,
+			      price_history->patterns.bits[yesterday_idx]);
+}
+
+static int good_up_day(const struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *price2check,
+		       int yesterday_idx)
+{
+	uint16_t bits = price2check_patterns(price_history, price2check, yesterday_idx);
+
+	if (price2check->candle_trend == CANDLE_TREND_BEAR)
+		return 0;
+
+	if (!(bits & CANDLE_P_HIGH_3D))
+		return 0;
+
+	if ((price2check->high - price2check->close) * 100 / (price2check->high - price2check->low) > 25
+	    && !(bits & CANDLE_P_LOW_OVER_3D))
+		return 0;
+
+	return 1;
+}
+
+static int sma20_slope_is_shallow(const struct date_price *day1)
+{
+	const struct date_price *day5 = day1 + 5;
+
+	/* sma20 slope needs be shalow: < 1.5% */
+	if (day1->sma[SMA_20d] < day5->sma[SMA_20d]
+	    && (day5->sma[SMA_20d] - day1->sma[SMA_20d]) * 1000 > day1->sma[SMA_20d] * 15)
+		return 0;
+
+	if (day1->sma[SMA_20d] >= day5->sma[SMA_20d]
+	    && (day1->sma[SMA_20d] - day5->sma[VMA_20d]) * 1000 >= day5->sma[VMA_20d] * 15)
+		return 0;
+
+	return 1;
+}
+
+static int is_sma_crossup(const struct check_ctx *ctx, const struct stock_price *price_history, const struct date_price *today,
+			  const struct date_price *yesterday)
+{
+	if (today->low < sma2check_at(ctx, price_history, yesterday) && today->close > sma2check_at(ctx, price_history, yesterday))
+		return 1;
+
+	if (today->close > sma2check_at(ctx, price_history, yesterday) && yesterday->low < sma2check_at(ctx, price_history, yesterday))
+		return 1;
+
+	return 0;
+}
+
+static void symbol_check_weeks_low_sma(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	int i, j;
+	uint32_t low_26week = -1;
+	int days = 250;
+
+	if (price2check->close < price2check->open || price2check->high == price2check->low)
+		return;
+
+
+	for (i = yesterday_idx; i < price_history->date_cnt; i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+
+		if (!sma2check_at(ctx, price_history, prev))
+			return;
+
+		if (prev->close > prev->sma[SMA_50d])
+			return;
+
+		if (!good_up_day(ctx, price_history, price2check, i))
+			return;
+
+		if ((uint64_t)price2check->volume * 100 < (uint64_t)prev->vma[VMA_20d] * 115)
+			return;
+
+		if (!sma20_slope_is_shallow(prev))
+			return;
+
+		if (is_sma_crossup(ctx, price_history, price2check, prev))
+			break;
+
+		return;
+	}
+
+	if (ctx->weeks2check == 0)
+		goto found;
+	else if (ctx->weeks2check == 26)
+		days = 130;
+	else if (ctx->weeks2check == 13)
+		days = 65;
+
+	for (j = 0; i < price_history->date_cnt && j < days; i++, j++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+
+		if (prev->close < low_26week)
+			low_26week = prev->close;
+	}
+
+	if (price2check->close < low_26week
+	    || (price2check->close - low_26week) * 100 / low_26week > 10)
+		return;
+
+found:
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static void symbol_check_sma_pullback(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday, *yesterday1, *yesterday2, *yesterday3;
+
+	if (yesterday_idx == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[yesterday_idx];
+	yesterday1 = yesterday + 1;
+	yesterday2 = yesterday + 2;
+	yesterday3 = yesterday + 3;
+
+	if (yesterday->candle_color != CANDLE_COLOR_RED
+	    && yesterday->high > sma2check_at(ctx, price_history, yesterday)
+	    && yesterday->volume > yesterday->vma[VMA_20d]
+	    && yesterday1->close < sma2check_at(ctx, price_history, yesterday1)
+	    && price2check->close < sma2check_at(ctx, price_history, yesterday))
+	{
+		goto is_pb;
+	}
+
+	if (yesterday1->candle_color == CANDLE_COLOR_GREEN
+	    && is_sma_crossup(ctx, price_history, yesterday1, yesterday2)
+	    && yesterday1->volume > yesterday1->vma[VMA_20d]
+	    && get_2ndhigh(price2check) < get_2ndhigh(yesterday1))
+	{
+		goto is_pb;
+	}
+
+	if (yesterday2->candle_color == CANDLE_COLOR_GREEN
+	    && is_sma_crossup(ctx, price_history, yesterday2, yesterday3)
+	    && yesterday2->volume > yesterday2->vma[VMA_20d]
+	    && get_2ndhigh(price2check) < get_2ndhigh(yesterday2))
+	{
+		goto is_pb;
+	}
+
+
+	return;
+
+is_pb:
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static void symbol_check_sma_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	int above_20d_cnt = 0;
+	int i = yesterday_idx, j;
+
+	if (i < price_history->date_cnt) {
+		const struct date_price *prev = &price_history->dateprice[i];
+
+		if (!is_sma_crossup(ctx, price_history, price2check, prev)
+		    || price2check->volume * 100 < prev->vma[VMA_20d] * 115)
+			return;
+
+		if (price2check->close <= prev->close
+		    || (price2check->close - prev->close) * 1000 / prev->close < 20)
+			return;
+
+		for (j = 0; i < price_history->date_cnt && j < 20; i++, j++) {
+			const struct date_price *prev = &price_history->dateprice[i];
+			if (prev->close > prev->sma[SMA_20d])
+				above_20d_cnt += 1;
+		}
+
+		if (above_20d_cnt > 3)
+			return;
+	}
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static void symbol_check_sma_trendup(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday;
+	uint64_t diff_low, diff_open;
+	int i, j;
+
+	if (price2check->close < price2check->open)
+		return;
+
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[i];
+
+	diff_low = price2check->low > sma2check_at(ctx, price_history, yesterday) ? (price2check->low - sma2check_at(ctx, price_history, yesterday)) : (sma2check_at(ctx, price_history, yesterday) - price2check->low);
+	diff_open = price2check->open > sma2check_at(ctx, price_history, yesterday) ? (price2check->open - sma2check_at(ctx, price_history, yesterday)) : (sma2check_at(ctx, price_history, yesterday) - price2check->open);
+
+	if (diff_low * 1000 / sma2check_at(ctx, price_history, yesterday) > 5 && diff_open * 1000 / sma2check_at(ctx, price_history, yesterday) > 5)
+		return;
+
+	for (j = 0; j < ctx->sma2check && i < price_history->date_cnt; i++, j++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		if (prev->close < sma2check_at(ctx, price_history, prev))
+			return;
+	}
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static void symbol_check_strong_sma_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday;
+	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
+	int i, j;
+
+	if (price2check->close < price2check->open)
+		return;
+
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[i];
+
+	if (!is_sma_crossup(ctx, price_history, price2check, yesterday)
+	    || is_sma_crossup(ctx, price_history, yesterday, yesterday+1)
+	    || price2check->volume * 100 < yesterday->vma[VMA_20d] * 125)
+		return;
+
+	for (j = 0; j < 15 && i < price_history->date_cnt; j++, i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		if (price2check_2ndhigh < get_2ndhigh(prev))
+			break;
+	}
+
+	if (j < 15)
+		return;
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static void symbol_check_sma_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday;
+	int i;
+
+	if (price2check->close < price2check->open)
+		return;
+
+	if (((get_2ndhigh(price2check) - price2check->low)) * 2 < price2check->high - price2check->low)
+		return;
+
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
+		return;
+
+	yesterday = &price_history->dateprice[i];
+
+	if (price2check->close < sma2check_at(ctx, price_history, yesterday))
+		return;
+
+	if (price2check->low > sma2check_at(ctx, price_history, yesterday)
+	    && yesterday->close > sma2check_at(ctx, price_history, yesterday))
+		return;
+
+	if ((uint64_t)price2check->volume * 100 < (uint64_t)yesterday->vma[VMA_20d] * 115)
+		return;
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s<sector=%s>%s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
+}
+
+static int get_date_count(const struct stock_price *price_history, uint32_t date1, uint32_t date2)
+{
+	uint32_t date_smaller, date_bigger;
+	int i, j;
+
+	if (date1 == date2)
+		return 0;
+
+	if (date1 > date2) {
+		date_smaller = date2;
+		date_bigger = date1;
+	}
+	else {
+		date_smaller = date1;
+		date_bigger = date2;
+	}
+
+	/* rows from the latest one not after date_bigger to date_smaller */
+	i = stock_price_date_before(price_history, date_bigger + 1);
+	if (i == price_history->date_cnt)
+		return 0;
+
+	j = stock_price_date_before(price_history, date_smaller + 1);
+	if (j == price_history->date_cnt || price_history->dateprice[j].date != date_smaller)
+		j = price_history->date_cnt;
+
+	return j - i;
+}
+
+static int datecnt_match_check_pullback(int check_pullback, int datecnt)
+{
+	if (check_pullback) {
+		if (datecnt > 25 || datecnt < 10)
+			return 0;
+	}
+	else {
+		if (datecnt <= 25 && datecnt >= 10)
+			return 0;
+	}
 
-	return output_str;
+	return 1;
 }
 
-static void symbol_check_support(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check)
+static void __symbol_check_doublebottom(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx, int check_pullback)
 {
 	struct stock_support sspt = { };
+	int i;
 
-	check_support(price_history, price2check, &sspt);
+	check_support(ctx, price_history, price2check, yesterday_idx, &sspt);
 
 	if (!sspt.date_nr)
 		return;
 
-	anna_info("%s%-10s%s: date=%s, %s; is supported by %d dates:",
-		  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		  price2check->date, get_price_volume_change(price_history, price2check), sspt.date_nr);
+	for (i = 0; i < sspt.date_nr; i++) {
+		if (sspt.is_doublebottom[i]) {
+			int datecnt = get_date_count(price_history, sspt.date[i], price2check->date);
 
-	anna_info("%s<sector=%s>%s.\n", ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+			if (!datecnt_match_check_pullback(check_pullback, datecnt))
+				return;
 
-	selected_symbol_nr += 1;
-}
+			check_info(ctx, "%s%-10s%s: date=" DATE_FMT "/" DATE_FMT "(%d days), %s; %s<sector=%s>%s.\n",
+				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(price2check->date), DATE_ARG(sspt.date[i]), datecnt,
+				get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+				ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
 
-static int good_up_day(const struct date_price *price2check, const struct date_price *yesterday)
-{
-	if (price2check->candle_trend == CANDLE_TREND_BEAR)
-		return 0;
+			ctx->selected_nr += 1;
 
-	if (price2check->high < yesterday->high
-	    || price2check->high < (yesterday + 1)->high
-	    || price2check->high < (yesterday + 2)->high)
-		return 0;
+			break;
+		}
+	}
+}
 
-	if ((price2check->high - price2check->close) * 100 / (price2check->high - price2check->low) > 25
-	    && (price2check->low < yesterday->high || price2check->low < (yesterday+1)->high || price2check->low < (yesterday+2)->high))
-		return 0;
+static void symbol_check_doublebottom(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_doublebottom(ctx, symbol, price_history, price2check, yesterday_idx, 0);
+}
 
-	return 1;
+static void symbol_check_pullback_doublebottom(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+						const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_doublebottom(ctx, symbol, price_history, price2check, yesterday_idx, 1);
 }
 
-static int sma20_slope_is_shallow(const struct date_price *day1)
+static void symbol_check_mfi_doublebottom(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *day5 = day1 + 5;
+	struct stock_support sspt = { };
+	const struct date_price *prev;
+	int i;
 
-	/* sma20 slope needs be shalow: < 1.5% */
-	if (day1->sma[SMA_20d] < day5->sma[SMA_20d]
-	    && (day5->sma[SMA_20d] - day1->sma[SMA_20d]) * 1000 > day1->sma[SMA_20d] * 15)
-		return 0;
+	check_support(ctx, price_history, price2check, yesterday_idx, &sspt);
 
-	if (day1->sma[SMA_20d] >= day5->sma[SMA_20d]
-	    && (day1->sma[SMA_20d] - day5->sma[VMA_20d]) * 1000 >= day5->sma[VMA_20d] * 15)
-		return 0;
+	if (!sspt.date_nr)
+		return;
 
-	return 1;
-}
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
+		return;
 
-static int is_sma_crossup(const struct date_price *today, const struct date_price *yesterday)
-{
-	if (today->low < yesterday->sma[sma2check] && today->close > yesterday->sma[sma2check])
-		return 1;
+	prev = &price_history->dateprice[i];
 
-	if (today->close > yesterday->sma[sma2check] && yesterday->low < yesterday->sma[sma2check])
-		return 1;
+	if (!sma20_slope_is_shallow(prev))
+		return;
 
-	return 0;
+	for (i = 0; i < sspt.date_nr; i++) {
+		uint32_t sspt_mfi = sspt.mfi[i] ? sspt.mfi[i] : 1;
+		uint32_t high_250d, low_250d;
+		int low_250d_percent = 0;
+		int mfi_diff_percent;
+
+		if (prev->mfi <= sspt_mfi)
+			continue;
+
+		get_250d_high_low(price_history, price2check, yesterday_idx, &high_250d, &low_250d);
+		if (price2check->low < low_250d)
+			check_info(ctx, "[%s:%s:%d] date=" DATE_FMT "'s low is larger than 250d_low: %d/%d\n",
+				   __FILE__, __FUNCTION__, __LINE__, DATE_ARG(price2check->date), price2check->low, low_250d);
+		else {
+			low_250d_percent = (price2check->low - low_250d) * 100 / low_250d;
+		}
+
+		mfi_diff_percent = (prev->mfi - sspt_mfi) * 100 / sspt_mfi;
+
+		if (sspt.is_doublebottom[i]
+		    && (mfi_diff_percent >= 100 ||
+			(low_250d_percent <= 15 && mfi_diff_percent >= 50 && prev->mfi <= 5500 && sspt_mfi <= 4500)))
+		{
+			uint32_t diff_mfi = prev->mfi - sspt.mfi[i];
+			check_info(ctx, "%s%-10s%s: date=" DATE_FMT "/" DATE_FMT ", %s; MFI(%d.%02d/%d.%02d=%d.%02d%%); %s<sector=%s>%s.\n",
+				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(price2check->date), DATE_ARG(sspt.date[i]),
+				get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+				prev->mfi / 100, prev->mfi % 100, sspt.mfi[i] / 100, sspt.mfi[i] % 100,
+				diff_mfi * 100 / sspt_mfi, diff_mfi * 100 % sspt_mfi,
+				ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+			ctx->selected_nr += 1;
+
+			break;
+		}
+	}
 }
 
-static void symbol_check_weeks_low_sma(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void __symbol_check_doublebottom_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx, int check_pullback, int strong)
 {
-	int i, j;
-	uint32_t low_26week = -1;
-	int days = 250;
+	const struct date_price *prev;
+	struct stock_support sspt = { };
+	int i;
 
-	if (price2check->close < price2check->open || price2check->high == price2check->low)
+	i = yesterday_idx;
+	if (i == price_history->date_cnt)
 		return;
 
+	prev = &price_history->dateprice[i];
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) <= 0)
-			continue;
-
-		if (!prev->sma[sma2check])
-			return;
+	if (price2check->high == price2check->low
+	    || ((price2check->high - price2check->close) * 100 / (price2check->high - price2check->low) >= 30))
+		return;
 
-		if (prev->close > prev->sma[SMA_50d])
-			return;
+	if (strong &&
+	    (price2check->volume * 100 < prev->vma[VMA_20d] * 150
+	     || price2check->close <= prev->close
+	     || (price2check->close - prev->close) * 1000 / prev->close < 20))
+		return;
+	else if (price2check->volume * 133 < prev->vma[VMA_20d] * 100)
+		return;
 
-		if (!good_up_day(price2check, prev))
-			return;
+	int use_today = (price2check->close < prev->close || (price2check->low < prev->low && get_2ndlow(price2check) < get_2ndlow(prev))) && price2check->candle_trend != CANDLE_TREND_BEAR;
 
-		if ((uint64_t)price2check->volume * 100 < (uint64_t)prev->vma[VMA_20d] * 115)
-			return;
+	check_support(ctx, price_history, use_today ? price2check : prev, use_today ? i : i + 1, &sspt);
 
-		if (!sma20_slope_is_shallow(prev))
-			return;
+	for (i = 0; i < sspt.date_nr; i++) {
+		if (sspt.is_doublebottom[i]) {
+			int datecnt = get_date_count(price_history, sspt.date[i], use_today ? price2check->date : prev->date);
 
-		if (is_sma_crossup(price2check, prev))
-			break;
+			if (datecnt < 9)
+				return;
 
-		return;
-	}
+			if (check_pullback && !datecnt_match_check_pullback(check_pullback, datecnt))
+				return;
 
-	if (weeks2check == 0)
-		goto found;
-	else if (weeks2check == 26)
-		days = 130;
-	else if (weeks2check == 13)
-		days = 65;
+			check_info(ctx, "%s%-10s%s: date=" DATE_FMT "/" DATE_FMT "(%d days), %s; %s<sector=%s>%s.\n",
+					ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(use_today ? price2check->date : prev->date), DATE_ARG(sspt.date[i]), datecnt,
+					get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+					ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
 
-	for (j = 0; i < price_history->date_cnt && j < days; i++, j++) {
-		const struct date_price *prev = &price_history->dateprice[i];
+			ctx->selected_nr += 1;
 
-		if (prev->close < low_26week)
-			low_26week = prev->close;
+			break;
+		}
 	}
+}
 
-	if (price2check->close < low_26week
-	    || (price2check->close - low_26week) * 100 / low_26week > 10)
-		return;
+static void symbol_check_doublebottom_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_doublebottom_up(ctx, symbol, price_history, price2check, yesterday_idx, 0, 0);
+}
 
-found:
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+static void symbol_check_pullback_doublebottom_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+						const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_doublebottom_up(ctx, symbol, price_history, price2check, yesterday_idx, 1, 0);
+}
 
-	selected_symbol_nr += 1;
+static void symbol_check_strong_doublebottom_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+						const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_doublebottom_up(ctx, symbol, price_history, price2check, yesterday_idx, 0, 1);
 }
 
-static void symbol_check_sma_pullback(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void symbol_check_higher_low(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *yesterday, *yesterday1, *yesterday2, *yesterday3;
+	const struct date_price *prev;
+	const struct date_price *higher_low;
 	int i;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0) {
-			yesterday1 = yesterday + 1;
-			yesterday2 = yesterday + 2;
-			yesterday3 = yesterday + 3;
-			break;
-		}
-	}
-
+	i = yesterday_idx;
 	if (i == price_history->date_cnt)
 		return;
 
-	if ((yesterday->close >= yesterday->open || yesterday->candle_color == CANDLE_COLOR_DOJI)
-	    && yesterday->high > yesterday->sma[sma2check]
-	    && yesterday->volume > yesterday->vma[VMA_20d]
-	    && yesterday1->close < yesterday1->sma[sma2check]
-	    && price2check->close < yesterday->sma[sma2check])
-	{
-		goto is_pb;
-	}
+	prev = &price_history->dateprice[i];
 
-	if (yesterday1->close > yesterday1->open
-	    && is_sma_crossup(yesterday1, yesterday2)
-	    && yesterday1->volume > yesterday1->vma[VMA_20d]
-	    && get_2ndhigh(price2check) < get_2ndhigh(yesterday1))
-	{
-		goto is_pb;
-	}
+	if (price2check->close <= prev->close || prev->close > (prev+1)->close
+	    || price2check->low < prev->low || prev->low > (prev+1)->low)
+		return;
 
-	if (yesterday2->close > yesterday2->open
-	    && is_sma_crossup(yesterday2, yesterday3)
-	    && yesterday2->volume > yesterday2->vma[VMA_20d]
-	    && get_2ndhigh(price2check) < get_2ndhigh(yesterday2))
-	{
-		goto is_pb;
-	}
+	higher_low = prev;
+	prev = prev + 3;
 
+	for (i = 0; i < 12; i++) {
+		if (prev->close < higher_low->close
+		    && prev->low < (prev+1)->low && prev->low <(prev+2)->low
+		    && prev->low < (prev-1)->low && prev->low < (prev-2)->low)
+			break;
 
-	return;
+		prev = prev + 1;
+	}
 
-is_pb:
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+	if (i < 12) {
+		check_info(ctx, "%s%-10s%s: date=" DATE_FMT "/" DATE_FMT ".\n",
+			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(higher_low->date), DATE_ARG(prev->date));
 
-	selected_symbol_nr += 1;
+		ctx->selected_nr += 1;
+	}
 }
 
-static void symbol_check_sma_breakout(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void symbol_check_pullback(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				  const struct date_price *price2check, int yesterday_idx)
 {
 	int i, j;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
+	for (i = yesterday_idx, j = 0; j < 20 && i < price_history->date_cnt; i++, j++) {
 		const struct date_price *prev = &price_history->dateprice[i];
 
-		if (strcmp(price2check->date, prev->date) > 0) {
-			int above_20d_cnt = 0;
-
-			if (!is_sma_crossup(price2check, prev)
-			    || price2check->volume * 100 < prev->vma[VMA_20d] * 115)
-				return;
+		if (!(prev->sr_flag & SR_F_BIGUPDAY))
+			continue;
 
-			if (price2check->close <= prev->close
-			    || (price2check->close - prev->close) * 1000 / prev->close < 20)
-				return;
+		uint32_t prev_2ndlow = get_2ndlow(prev);
+		uint32_t price2check_2ndlow = get_2ndlow(price2check);
 
-			for (j = 0; i < price_history->date_cnt && j < 20; i++, j++) {
-				const struct date_price *prev = &price_history->dateprice[i];
-				if (prev->close > prev->sma[SMA_20d])
-					above_20d_cnt += 1;
-			}
+		if (sr_hit(price2check->low, prev->low) || sr_hit(price2check_2ndlow, prev->low)
+		    || sr_hit(price2check->low, prev_2ndlow) || sr_hit(price2check_2ndlow, prev_2ndlow))
+		{
+			check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; is at support bigupdate=" DATE_FMT "; %s<sector=%s>%s.\n",
+				  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+				  DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx), DATE_ARG(prev->date),
+				  ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
 
-			if (above_20d_cnt > 3)
-				return;
+			ctx->selected_nr += 1;
 
 			break;
 		}
 	}
-
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
-
-	selected_symbol_nr += 1;
 }
 
-static void symbol_check_sma_trendup(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void __symbol_check_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx, int strong, int second_bo)
 {
-	const struct date_price *yesterday;
-	uint64_t diff_low, diff_open;
+	struct stock_support sspt = { };
 	int i, j;
 
-	if (price2check->close < price2check->open)
-		return;
-
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
-	}
+	check_breakout(ctx, price_history, price2check, yesterday_idx, &sspt, strong);
 
-	if (i == price_history->date_cnt)
+	if (!sspt.date_nr)
 		return;
 
-	diff_low = price2check->low > yesterday->sma[sma2check] ? (price2check->low - yesterday->sma[sma2check]) : (yesterday->sma[sma2check] - price2check->low);
-	diff_open = price2check->open > yesterday->sma[sma2check] ? (price2check->open - yesterday->sma[sma2check]) : (yesterday->sma[sma2check] - price2check->open);
-
-	if (diff_low * 1000 / yesterday->sma[sma2check] > 5 && diff_open * 1000 / yesterday->sma[sma2check] > 5)
-		return;
+	if (second_bo && yesterday_idx < price_history->date_cnt) {
+		for (i = yesterday_idx, j = 0; j < 5 && i < price_history->date_cnt; i++, j++) {
+			const struct date_price *prev = &price_history->dateprice[i];
+			if (prev->high >= sspt.avg_spt_price)
+				break;
+		}
 
-	for (j = 0; j < sma_days[sma2check] && i < price_history->date_cnt; i++, j++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (prev->close < prev->sma[sma2check])
+		if (j == 5)
 			return;
 	}
 
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; breakout with %d dates:",
+		  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		  DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx), sspt.date_nr);
 
-	selected_symbol_nr += 1;
+	check_info(ctx, "%s<sector=%s>%s.\n", ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+	ctx->selected_nr += 1;
 }
 
-static void symbol_check_strong_sma_up(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void symbol_check_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *yesterday;
-	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
-	int i, j;
+	__symbol_check_breakout(ctx, symbol, price_history, price2check, yesterday_idx, 0, 0);
+}
 
-	if (price2check->close < price2check->open)
-		return;
+static void symbol_check_2nd_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_breakout(ctx, symbol, price_history, price2check, yesterday_idx, 0, 1);
+}
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
-	}
+static int date_is_trend_breakout(const struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday = NULL;
+	uint32_t recent_high;
+	int i = yesterday_idx;
+
+	if (price2check->candle_trend == CANDLE_TREND_BEAR || price2check->high == price2check->low)
+		return 0;
 
 	if (i == price_history->date_cnt)
-		return;
+		return 0;
 
-	if (!is_sma_crossup(price2check, yesterday)
-	    || is_sma_crossup(yesterday, yesterday+1)
-	    || price2check->volume * 100 < yesterday->vma[VMA_20d] * 125)
-		return;
+	yesterday = &price_history->dateprice[i];
 
-	for (j = 0; j < 15 && i < price_history->date_cnt; j++, i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (price2check_2ndhigh < get_2ndhigh(prev))
-			break;
-	}
+	if (!good_up_day(ctx, price_history, price2check, i))
+		return 0;
 
-	if (j < 15)
-		return;
+	if (price2check->volume * 100 < yesterday->vma[VMA_20d] * 115)
+		return 0;
 
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+	if (!sma20_slope_is_shallow(yesterday))
+		return 0;
+
+	recent_high = stock_price_range(price_history, PRICE_RANGE_2ndHIGH, i, 40);
+	if (recent_high < get_2ndhigh(price2check))
+		recent_high = get_2ndhigh(price2check);
+
+	/* diff from recent_high < 5% */
+	if ((recent_high - get_2ndhigh(price2check)) * 1000 / get_2ndhigh(price2check) <= 50)
+		return 0;
 
-	selected_symbol_nr += 1;
+	return 1;
 }
 
-static void symbol_check_sma_up(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check)
+static void symbol_check_trend_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *yesterday;
+	const struct date_price *yesterday = NULL;
 	int i;
 
-	if (price2check->close < price2check->open)
-		return;
-
-	if (((get_2ndhigh(price2check) - price2check->low)) * 2 < price2check->high - price2check->low)
+	if (price2check->candle_trend == CANDLE_TREND_BEAR || price2check->high == price2check->low)
 		return;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
-	}
-
+	i = yesterday_idx;
 	if (i == price_history->date_cnt)
 		return;
 
-	if (price2check->close < yesterday->sma[sma2check])
+	yesterday = &price_history->dateprice[i];
+
+	if (price2check->close <= yesterday->close
+	    || (price2check->close - yesterday->close) * 1000 / yesterday->close < 20)
 		return;
 
-	if (price2check->low > yesterday->sma[sma2check]
-	    && yesterday->close > yesterday->sma[sma2check])
+	if (date_is_trend_breakout(ctx, symbol, price_history, yesterday, i + 1))
 		return;
 
-	if ((uint64_t)price2check->volume * 100 < (uint64_t)yesterday->vma[VMA_20d] * 115)
+	if (!date_is_trend_breakout(ctx, symbol, price_history, price2check, i))
 		return;
 
-	anna_info("%s%-10s%s: date=%s, %s; %s<sector=%s>%s.\n",
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s.\n",
 		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		price_history->sector);
 
-	selected_symbol_nr += 1;
+	ctx->selected_nr += 1;
 }
 
-static int get_date_count(const struct stock_price *price_history, const char *date1, const char *date2)
+static void symbol_check_strong_uptrend(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
 {
-	const char *date_smaller, *date_bigger;
-	int cmp = strcmp(date1, date2);
+	const struct date_price *yesterday = NULL;
+	int days_below_sma20 = -1;
 	int i, j;
 
-	cmp = strcmp(date1, date2);
-	if (cmp == 0)
-		return 0;
-
-	if (cmp > 0) {
-		date_smaller = date2;
-		date_bigger = date1;
-	}
-	else {
-		date_smaller = date1;
-		date_bigger = date2;
-	}
+	for (i = yesterday_idx, j = 0; i < price_history->date_cnt && j < 25; i++, j++) {
+		const struct date_price *prev = &price_history->dateprice[i];
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *cur = &price_history->dateprice[i];
-		if (strcmp(cur->date, date_bigger) > 0)
-			continue;
+		if (yesterday == NULL)
+			yesterday = prev;
 
-		for (j = i; j < price_history->date_cnt; j++) {
-			cur = &price_history->dateprice[j];
-			if (strcmp(cur->date, date_smaller) == 0)
-				break;
+		if (prev->close < prev->sma[SMA_20d]) {
+			if (days_below_sma20 < 0)
+				days_below_sma20 = 0;
+			days_below_sma20 += 1;
 		}
-
-		return j - i;
 	}
 
-	return 0;
-}
-
-static int datecnt_match_check_pullback(int check_pullback, int datecnt)
-{
-	if (check_pullback) {
-		if (datecnt > 25 || datecnt < 10)
-			return 0;
-	}
-	else {
-		if (datecnt <= 25 && datecnt >= 10)
-			return 0;
+	if (days_below_sma20 >= 0 && days_below_sma20 <= 4
+	    && (price2check->close > yesterday->sma[SMA_20d] && (price2check->low < yesterday->sma[SMA_20d] || yesterday->close < yesterday->sma[SMA_20d])))
+	{
+		check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", days_below_sma20=%d, %s; %s<sector=%s>%s.\n",
+			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+			DATE_ARG(price2check->date), days_below_sma20, get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+			ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+		ctx->selected_nr += 1;
 	}
-
-	return 1;
 }
 
-static void __symbol_check_doublebottom(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check, int check_pullback)
+/* lower low and raise high to the 2ndlow/2ndhigh of nr traded (volume != 0) rows from row i */
+static void get_traded_2nd_extremes(const struct stock_price *price_history, int i, int nr,
+				    uint32_t *low, uint32_t *high)
 {
-	struct stock_support sspt = { };
-	int i;
+	uint32_t low_nr, high_nr;
+	int j;
 
-	check_support(price_history, price2check, &sspt);
+	/* no untraded row among the nr rows from i, the usual case */
+	if (stock_price_range(price_history, PRICE_RANGE_VOLUME, i, nr) > 0) {
+		low_nr = stock_price_range(price_history, PRICE_RANGE_2ndLOW, i, nr);
+		high_nr = stock_price_range(price_history, PRICE_RANGE_2ndHIGH, i, nr);
 
-	if (!sspt.date_nr)
+		if (low_nr < *low)
+			*low = low_nr;
+		if (high_nr > *high)
+			*high = high_nr;
 		return;
+	}
 
-	for (i = 0; i < sspt.date_nr; i++) {
-		if (sspt.is_doublebottom[i]) {
-			int datecnt = get_date_count(price_history, sspt.date[i], price2check->date);
-
-			if (!datecnt_match_check_pullback(check_pullback, datecnt))
-				return;
+	for (j = 0; i < price_history->date_cnt && j < nr; i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
 
-			anna_info("%s%-10s%s: date=%s/%s(%d days), %s; %s<sector=%s>%s.\n",
-				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, price2check->date, sspt.date[i], datecnt,
-				get_price_volume_change(price_history, price2check),
-				ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+		if (prev->volume == 0)
+			continue;
 
-			selected_symbol_nr += 1;
+		if (get_2ndlow(prev) < *low)
+			*low = get_2ndlow(prev);
+		if (get_2ndhigh(prev) > *high)
+			*high = get_2ndhigh(prev);
 
-			break;
-		}
+		j += 1;
 	}
 }
 
-static void symbol_check_doublebottom(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
-{
-	__symbol_check_doublebottom(symbol, price_history, price2check, 0);
-}
-
-static void symbol_check_pullback_doublebottom(const char *symbol, const struct stock_price *price_history,
-						const struct date_price *price2check)
-{
-	__symbol_check_doublebottom(symbol, price_history, price2check, 1);
-}
-
-static void symbol_check_mfi_doublebottom(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
+static void __symbol_check_strong_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx, int strong_body)
 {
-	struct stock_support sspt = { };
-	const struct date_price *prev;
-	int i;
-
-	check_support(price_history, price2check, &sspt);
+#define STRONG_BO_MAX_DAYS   5
+	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
+	const struct date_price *yesterday = NULL;
+	uint32_t price2check_2ndlow = get_2ndlow(price2check);
+	uint32_t low_40day = price2check_2ndlow;
+	uint32_t high_40day = price2check_2ndhigh;
+	int i, j;
 
-	if (!sspt.date_nr)
+	/* must be bull trend bar */
+	if (price2check->candle_trend == CANDLE_TREND_BEAR && price2check->close < price2check->open)
 		return;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) > 0)
+	/* the latest traded day before */
+	for (i = yesterday_idx; i < price_history->date_cnt; i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		if (prev->volume) {
+			yesterday = prev;
 			break;
+		}
 	}
 
-	if (i == price_history->date_cnt)
-		return;
+	if (yesterday) {
+		/* if not strong_body, volume needs be enough */
+		if (!strong_body && price2check->volume < yesterday->vma[VMA_20d])
+			return;
+		if (strong_body && ((uint64_t)price2check->volume * 100) < ((uint64_t)yesterday->vma[VMA_20d] * 75))
+			return;
+		if (price2check->close <= yesterday->close
+		    || (price2check->close - yesterday->close) * 1000 / yesterday->close < 20)
+			return;
 
-	if (!sma20_slope_is_shallow(prev))
-		return;
+		get_traded_2nd_extremes(price_history, i, 40, &low_40day, &high_40day);
+	}
 
-	for (i = 0; i < sspt.date_nr; i++) {
-		uint32_t sspt_mfi = sspt.mfi[i] ? sspt.mfi[i] : 1;
-		uint32_t high_250d, low_250d;
-		int low_250d_percent = 0;
-		int mfi_diff_percent;
+	if (high_40day == price2check_2ndhigh
+	    || (price2check_2ndlow > low_40day && (price2check_2ndlow - low_40day) * 100 / low_40day > 10))
+		return;
 
-		if (prev->mfi <= sspt_mfi)
-			continue;
+	if (strong_body) {
+		uint64_t body_size;
 
-		get_250d_high_low(price_history, price2check, &high_250d, &low_250d);
-		if (price2check->low < low_250d)
-			printf("[%s:%s:%d] date=%s's low is larger than 250d_low: %d/%d\n",
-				__FILE__, __FUNCTION__, __LINE__, price2check->date, price2check->low, low_250d);
-		else {
-			low_250d_percent = (price2check->low - low_250d) * 100 / low_250d;
-		}
+		if (price2check->candle_trend == CANDLE_TREND_DOJI)
+			return;
 
-		mfi_diff_percent = (prev->mfi - sspt_mfi) * 100 / sspt_mfi;
+                if (price2check->close >= price2check->open)
+                        body_size = price2check->close - price2check->open;
+                else
+                        body_size = price2check->open - price2check->close;
 
-		if (sspt.is_doublebottom[i]
-		    && (mfi_diff_percent >= 100 ||
-			(low_250d_percent <= 15 && mfi_diff_percent >= 50 && prev->mfi <= 5500 && sspt_mfi <= 4500)))
-		{
-			uint32_t diff_mfi = prev->mfi - sspt.mfi[i];
-			anna_info("%s%-10s%s: date=%s/%s, %s; MFI(%d.%02d/%d.%02d=%d.%02d%%); %s<sector=%s>%s.\n",
-				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, price2check->date, sspt.date[i],
-				get_price_volume_change(price_history, price2check),
-				prev->mfi / 100, prev->mfi % 100, sspt.mfi[i] / 100, sspt.mfi[i] % 100,
-				diff_mfi * 100 / sspt_mfi, diff_mfi * 100 % sspt_mfi,
-				ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+		if (body_size * 1000 / price2check->open < 10) /* body size >= 1% */
+			return;
+	}
 
-			selected_symbol_nr += 1;
+	for (i = yesterday_idx, j = 0; i < price_history->date_cnt && j < STRONG_BO_MAX_DAYS; i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		if (prev->volume == 0)
+			continue;
 
+		uint64_t prev_2ndhigh = get_2ndhigh(prev);
+		uint64_t price2check_2ndlow = get_2ndlow(price2check);
+		if (price2check_2ndhigh < prev->high
+		    || (prev_2ndhigh > price2check_2ndlow
+			&& (prev_2ndhigh - price2check_2ndlow) * 10000 / prev_2ndhigh >= 70))
+		{
 			break;
 		}
+		j += 1;
 	}
+
+	if (j < STRONG_BO_MAX_DAYS)
+		return;
+
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		price_history->sector);
+
+	ctx->selected_nr += 1;
 }
 
-static void __symbol_check_doublebottom_up(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check, int check_pullback, int strong)
+static void symbol_check_strong_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *prev;
-	struct stock_support sspt = { };
-	int i;
+	__symbol_check_strong_breakout(ctx, symbol, price_history, price2check, yesterday_idx, 0);
+}
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		prev = &price_history->dateprice[i];
+static void symbol_check_strong_body_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+						 const struct date_price *price2check, int yesterday_idx)
+{
+	__symbol_check_strong_breakout(ctx, symbol, price_history, price2check, yesterday_idx, 1);
+}
 
-		if (strcmp(price2check->date, prev->date) > 0)
-			break;
-	}
+static void symbol_check_resist_breakout(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					 const struct date_price *price2check, int yesterday_idx)
+{
+	const struct date_price *yesterday;
+	int i, j, matched_date = 0;
+	uint32_t yesterday_2ndlow;
+	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
 
+	i = yesterday_idx;
 	if (i == price_history->date_cnt)
 		return;
 
-	if (price2check->high == price2check->low
-	    || ((price2check->high - price2check->close) * 100 / (price2check->high - price2check->low) >= 30))
-		return;
+	yesterday = &price_history->dateprice[i];
 
-	if (strong &&
-	    (price2check->volume * 100 < prev->vma[VMA_20d] * 150
-	     || price2check->close <= prev->close
-	     || (price2check->close - prev->close) * 1000 / prev->close < 20))
-		return;
-	else if (price2check->volume * 133 < prev->vma[VMA_20d] * 100)
+	if (price2check->volume * 100 < yesterday->vma[VMA_20d] * 115)
 		return;
 
-	int use_today = (price2check->close < prev->close || (price2check->low < prev->low && get_2ndlow(price2check) < get_2ndlow(prev))) && price2check->candle_trend != CANDLE_TREND_BEAR;
-
-	check_support(price_history, use_today ? price2check : prev, &sspt);
+	i += 1;
 
-	for (i = 0; i < sspt.date_nr; i++) {
-		if (sspt.is_doublebottom[i]) {
-			int datecnt = get_date_count(price_history, sspt.date[i], use_today ? price2check->date : prev->date);
+	if (i == price_history->date_cnt)
+		return;
 
-			if (datecnt < 9)
-				return;
+	yesterday_2ndlow = get_2ndlow(yesterday);
 
-			if (check_pullback && !datecnt_match_check_pullback(check_pullback, datecnt))
-				return;
+	for (j = 0; j < 250 && i < price_history->date_cnt; i++, j++) {
+		const struct date_price *prev = &price_history->dateprice[i];
+		uint32_t prev_2ndhigh = get_2ndhigh(prev);
 
-			anna_info("%s%-10s%s: date=%s/%s(%d days), %s; %s<sector=%s>%s.\n",
-					ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, use_today ? price2check->date : prev->date, sspt.date[i], datecnt,
-					get_price_volume_change(price_history, price2check),
-					ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+		if (prev_2ndhigh >= price2check_2ndhigh)
+			break;
 
-			selected_symbol_nr += 1;
+		/* kept as it was: every row is skipped, so the screen matches nothing */
+		if (!is_resist(prev->sr_flag))
+			;
+		continue;
 
-			break;
+		if (prev->sr_flag & SR_F_RESIST_HIGH) {
+			if (price2check->close > prev->high
+			    && (price2check->low < prev->high || yesterday_2ndlow < prev->high))
+				matched_date += 1;
+		}
+		else if (prev->sr_flag & SR_F_RESIST_HIGH) {
+			if (price2check->close > prev_2ndhigh
+			    && (price2check->low < prev_2ndhigh || yesterday_2ndlow < prev_2ndhigh))
+				matched_date += 1;
 		}
 	}
-}
 
-static void symbol_check_doublebottom_up(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
-{
-	__symbol_check_doublebottom_up(symbol, price_history, price2check, 0, 0);
-}
+	if (matched_date < 2)
+		return;
 
-static void symbol_check_pullback_doublebottom_up(const char *symbol, const struct stock_price *price_history,
-						const struct date_price *price2check)
-{
-	__symbol_check_doublebottom_up(symbol, price_history, price2check, 1, 0);
-}
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", matched_date=%d, %s; %s.\n",
+		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		DATE_ARG(price2check->date), matched_date, get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+		price_history->sector);
+
+	ctx->selected_nr += 1;
 
-static void symbol_check_strong_doublebottom_up(const char *symbol, const struct stock_price *price_history,
-						const struct date_price *price2check)
-{
-	__symbol_check_doublebottom_up(symbol, price_history, price2check, 0, 1);
 }
 
-static void symbol_check_higher_low(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
+static void symbol_check_mfi(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				 const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *prev;
-	const struct date_price *higher_low;
-	int i;
-
-	for (i = 0; i < price_history->date_cnt; i++) {
-		prev = &price_history->dateprice[i];
-
-		if (strcmp(price2check->date, prev->date) > 0)
-			break;
-	}
-
-	if (i == price_history->date_cnt)
-		return;
+	const struct date_price *yesterday, *prev_20d;
 
-	if (price2check->close <= prev->close || prev->close > (prev+1)->close
-	    || price2check->low < prev->low || prev->low > (prev+1)->low)
+	if (yesterday_idx == price_history->date_cnt)
 		return;
 
-	higher_low = prev;
-	prev = prev + 3;
-
-	for (i = 0; i < 12; i++) {
-		if (prev->close < higher_low->close
-		    && prev->low < (prev+1)->low && prev->low <(prev+2)->low
-		    && prev->low < (prev-1)->low && prev->low < (prev-2)->low)
-			break;
-
-		prev = prev + 1;
-	}
+	yesterday = &price_history->dateprice[yesterday_idx];
+	prev_20d = yesterday + 20;
 
-	if (i < 12) {
-		anna_info("%s%-10s%s: date=%s/%s.\n",
-			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, higher_low->date, prev->date);
+	if (yesterday->mfi > prev_20d->mfi && prev_20d->mfi
+	    && (yesterday->mfi - prev_20d->mfi) * 100 / (prev_20d->mfi >= 0 ? prev_20d->mfi : -prev_20d->mfi) >= 25
+	    && yesterday->close < prev_20d->close
+	    && price2check->volume * 100 / yesterday->vma[VMA_20d] <= 60)
+	{
+		check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s.\n",
+				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+				DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+				price_history->sector);
 
-		selected_symbol_nr += 1;
+		ctx->selected_nr += 1;
 	}
 }
 
-static void symbol_check_pullback(const char *symbol, const struct stock_price *price_history,
-				  const struct date_price *price2check)
+static void symbol_check_reverse_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *yesterday = NULL;
-	int i, j;
-
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
-	}
-
-	for (j = 0; j < 20 && i < price_history->date_cnt; i++, j++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-
-		if (!(prev->sr_flag & SR_F_BIGUPDAY))
-			continue;
+	int i;
 
-		uint32_t prev_2ndlow = get_2ndlow(prev);
-		uint32_t price2check_2ndlow = get_2ndlow(price2check);
+	for (i = yesterday_idx; i < price_history->date_cnt; i++) {
+		const struct date_price *yesterday = &price_history->dateprice[i];
+		uint16_t bits = price_history->patterns.bits[i];
 
-		if (sr_hit(price2check->low, prev->low) || sr_hit(price2check_2ndlow, prev->low)
-		    || sr_hit(price2check->low, prev_2ndlow) || sr_hit(price2check_2ndlow, prev_2ndlow))
+		if (yesterday->volume * 100 < yesterday->vma[VMA_20d] * 120
+		    || (bits & CANDLE_P_CLOSE_OVER_HIGH)
+		    || price2check->close < yesterday->high
+		    || price2check->close < (yesterday+1)->high)
+			return;
+
+		if (bits & CANDLE_P_RED_AFTER_GREEN)
 		{
-			anna_info("%s%-10s%s: date=%s, %s; is at support bigupdate=%s; %s<sector=%s>%s.\n",
-				  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-				  price2check->date, get_price_volume_change(price_history, price2check), prev->date,
-				  ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+			check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; %s.\n",
+				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+				DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx),
+				price_history->sector);
 
-			selected_symbol_nr += 1;
+			ctx->selected_nr += 1;
 
-			break;
 		}
+		break;
 	}
 }
 
-static void __symbol_check_breakout(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check, int strong, int second_bo)
+static void symbol_check_52w_low_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				    const struct date_price *price2check, int yesterday_idx)
 {
-	struct stock_support sspt = { };
-	int i, j;
-
-	check_breakout(price_history, price2check, &sspt, strong);
+	const struct date_price *yesterday = NULL;
+	uint32_t price2check_2ndlow = get_2ndlow(price2check);
+	uint32_t yesterday_2ndlow;
+	uint32_t is_52w_low = 1, is_52w_2ndlow = 1;
+	int i = yesterday_idx, j;
 
-	if (!sspt.date_nr)
+	if (i == price_history->date_cnt)
 		return;
 
-	if (second_bo) {
-		for (i = 0; i < price_history->date_cnt; i++) {
-			const struct date_price *prev = &price_history->dateprice[i];
-			if (strcmp(price2check->date, prev->date) <= 0)
-				continue;
+	yesterday = &price_history->dateprice[i];
+	yesterday_2ndlow = get_2ndlow(yesterday);
 
-			for (j = 0; j < 5 && i < price_history->date_cnt; i++, j++) {
-				const struct date_price *prev = &price_history->dateprice[i];
-				if (prev->high >= sspt.avg_spt_price)
-					break;
-			}
+	if (price2check->low < yesterday->low && price2check_2ndlow < yesterday_2ndlow) {
+		is_52w_low = is_52w_2ndlow = 0;
+	}
+	else {
+		for (j = i + 1; j < price_history->date_cnt && (j - i) <= 250; j++) {
+			const struct date_price *prev = &price_history->dateprice[j];
+
+			if (prev->low < yesterday->low)
+				is_52w_low = 0;
+			if (get_2ndlow(prev) < yesterday_2ndlow)
+				is_52w_2ndlow = 0;
 
-			if (j < 5)
+			if (!is_52w_low && !is_52w_2ndlow)
 				break;
-			else
-				return;
 		}
 	}
 
-	anna_info("%s%-10s%s: date=%s, %s; breakout with %d dates:",
-		  ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		  price2check->date, get_price_volume_change(price_history, price2check), sspt.date_nr);
-
-	anna_info("%s<sector=%s>%s.\n", ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+	if ((is_52w_low || is_52w_2ndlow)
+	    && (get_2ndhigh(price2check) > get_2ndhigh(yesterday)
+	        || (price2check->low >= yesterday->low && price2check_2ndlow >= yesterday_2ndlow))
+	   )
+	{
+		check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s, is up from 52w low date=" DATE_FMT ".\n",
+			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(price2check->date),
+			get_price_volume_change(ctx, price_history, price2check, yesterday_idx), DATE_ARG(yesterday->date));
 
-	selected_symbol_nr += 1;
+		ctx->selected_nr += 1;
+	}
 }
 
-static void symbol_check_breakout(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check)
+static void get_52w_low(const struct stock_price *price_history, int yesterday_idx,
+			uint32_t *low, uint32_t *second_low)
 {
-	__symbol_check_breakout(symbol, price_history, price2check, 0, 0);
+	*low = stock_price_range(price_history, PRICE_RANGE_LOW, yesterday_idx, 250);
+	*second_low = stock_price_range(price_history, PRICE_RANGE_2ndLOW, yesterday_idx, 250);
 }
 
-static void symbol_check_2nd_breakout(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check)
+static int near_52w_low(const struct date_price *price2check, uint32_t low_52w, uint32_t second_low_52w)
 {
-	__symbol_check_breakout(symbol, price_history, price2check, 0, 1);
-}
+	uint32_t diff;
+	uint32_t price2check_2ndlow;
 
-static int date_is_trend_breakout(const char *symbol, const struct stock_price *price_history,
-				const struct date_price *price2check)
-{
-	const struct date_price *yesterday = NULL;
-	uint32_t recent_high;
-	int i;
+	if (price2check->low > low_52w)
+		diff = price2check->low - low_52w;
+	else
+		diff = low_52w - price2check->low;
+	if (diff * 1000 / low_52w <= 50)
+		return 1;
 
-	if (price2check->candle_trend == CANDLE_TREND_BEAR || price2check->high == price2check->low)
-		return 0;
+	if (price2check->low > second_low_52w)
+		diff = price2check->low - second_low_52w;
+	else
+		diff = second_low_52w - price2check->low;
+	if (diff * 1000 / second_low_52w <= 50)
+		return 1;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
+	price2check_2ndlow = get_2ndlow(price2check);
 
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
-	}
+	if (price2check_2ndlow > low_52w)
+		diff = price2check_2ndlow - low_52w;
+	else
+		diff = low_52w - price2check_2ndlow;
+	if (diff * 1000 / low_52w <= 50)
+		return 1;
 
-	if (i == price_history->date_cnt)
-		return 0;
+	if (price2check_2ndlow > second_low_52w)
+		diff = price2check_2ndlow - second_low_52w;
+	else
+		diff = second_low_52w - price2check_2ndlow;
+	if (diff * 1000 / second_low_52w <= 50)
+		return 1;
 
-	if (!good_up_day(price2check, yesterday))
-		return 0;
+	return 0;
+}
 
-	if (price2check->volume * 100 < yesterday->vma[VMA_20d] * 115)
-		return 0;
+static void symbol_check_52w_doublebottom(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+					const struct date_price *price2check, int yesterday_idx)
+{
+	struct stock_support sspt = { };
+	int i;
 
-	if (!sma20_slope_is_shallow(yesterday))
-		return 0;
+	check_support(ctx, price_history, price2check, yesterday_idx, &sspt);
 
-	recent_high = get_2ndhigh(price2check);
+	if (!sspt.date_nr)
+		return;
 
-	for (i = 0; i < 40; i++) {
-		const struct date_price *prev = yesterday + i;
-		if (get_2ndhigh(prev) > recent_high)
-			recent_high = get_2ndhigh(prev);
-	}
+	for (i = 0; i < sspt.date_nr; i++) {
+		if (sspt.is_doublebottom[i]) {
+			uint32_t low_52w, second_low_52w;
 
-	/* diff from recent_high < 5% */
-	if ((recent_high - get_2ndhigh(price2check)) * 1000 / get_2ndhigh(price2check) <= 50)
-		return 0;
+			get_52w_low(price_history, yesterday_idx, &low_52w, &second_low_52w);
 
-	return 1;
+			if (near_52w_low(price2check, low_52w, second_low_52w)) {
+				check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s; is double bottom with dates=" DATE_FMT "; %s<sector=%s>%s.\n",
+					ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, DATE_ARG(price2check->date),
+					get_price_volume_change(ctx, price_history, price2check, yesterday_idx), DATE_ARG(sspt.date[i]),
+					ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+
+				ctx->selected_nr += 1;
+			}
+
+			break;
+		}
+	}
 }
 
-static void symbol_check_trend_breakout(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+static void symbol_check_52w_doublebottom_up(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+                                        const struct date_price *price2check, int yesterday_idx)
 {
-	const struct date_price *yesterday = NULL;
-	int i;
-
-	if (price2check->candle_trend == CANDLE_TREND_BEAR || price2check->high == price2check->low)
-		return;
+	int i, cnt = 0;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
+	for (i = yesterday_idx; i < price_history->date_cnt; i++) {
+		const struct date_price *prev = &price_history->dateprice[i];
 
-		if (strcmp(price2check->date, yesterday->date) > 0)
+		if (cnt >= 2)
 			break;
-	}
 
-	if (i == price_history->date_cnt)
-		return;
+		cnt += 1;
 
-	if (price2check->close <= yesterday->close
-	    || (price2check->close - yesterday->close) * 1000 / yesterday->close < 20)
-		return;
+		if (price2check->close < prev->close)
+			continue;
 
-	if (date_is_trend_breakout(symbol, price_history, yesterday))
-		return;
+		int saved = ctx->selected_nr;
 
-	if (!date_is_trend_breakout(symbol, price_history, price2check))
-		return;
+		symbol_check_52w_doublebottom(ctx, symbol, price_history, price2check, yesterday_idx);
 
-	anna_info("%s%-10s%s: date=%s, %s; %s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		price_history->sector);
+		if (ctx->selected_nr > saved)
+			break;
+	}
+}
 
-	selected_symbol_nr += 1;
+static void symbol_check_change(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+				const struct date_price *price2check, int yesterday_idx)
+{
+	check_info(ctx, "%s%-10s%s: date=" DATE_FMT ", %s.\n", ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
+		  DATE_ARG(price2check->date), get_price_volume_change(ctx, price_history, price2check, yesterday_idx));
 }
 
-static void symbol_check_strong_uptrend(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
+/*
+ * the screens that check symbols, by name. each has its own context in a
+ * run of several screens, see stock_price_check_screens().
+ */
+struct check_screen
 {
-	const struct date_price *yesterday = NULL;
-	int days_below_sma20 = -1;
-	int i, j;
+	const char *name;
+	const char *title; /* above its output in a run of several screens */
+	void (*check_func)(struct check_ctx *ctx, const char *symbol, const struct stock_price *price_history,
+			   const struct date_price *price2check, int yesterday_idx);
+	int sma2check;
+	int weeks2check;
+};
 
-	for (i = 0, j = 0; i < price_history->date_cnt && j < 25; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) >0) {
-			if (yesterday == NULL)
-				yesterday = prev;
-
-			if (prev->close < prev->sma[SMA_20d]) {
-				if (days_below_sma20 < 0)
-					days_below_sma20 = 0;
-				days_below_sma20 += 1;
-			}
-			j += 1;
-		}
-	}
+static const struct check_screen check_screens[] =
+{
+	{ .name = "check-spt", .title = "Support",
+	  .check_func = symbol_check_support, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-20d", .title = "SMA20d Support",
+	  .check_func = symbol_check_support, .sma2check = 20, .weeks2check = 0 },
+	{ .name = "check-30d", .title = "SMA30d Support",
+	  .check_func = symbol_check_support, .sma2check = 30, .weeks2check = 0 },
+	{ .name = "check-50d", .title = "SMA50d Support",
+	  .check_func = symbol_check_support, .sma2check = 50, .weeks2check = 0 },
+	{ .name = "check-60d", .title = "SMA60d Support",
+	  .check_func = symbol_check_support, .sma2check = 60, .weeks2check = 0 },
+	{ .name = "check-20dlow", .title = "13w Low SMA20d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 20, .weeks2check = 13 },
+	{ .name = "check-50dlow", .title = "13w Low SMA50d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 50, .weeks2check = 13 },
+	{ .name = "check-26w20dlow", .title = "26w Low SMA20d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 20, .weeks2check = 26 },
+	{ .name = "check-26w50dlow", .title = "26w Low SMA50d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 50, .weeks2check = 26 },
+	{ .name = "check-10dup", .title = "SMA10d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 10, .weeks2check = 0 },
+	{ .name = "check-20dup", .title = "SMA20d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 20, .weeks2check = 0 },
+	{ .name = "check-strong-20dup", .title = "Strong SMA20d Up",
+	  .check_func = symbol_check_strong_sma_up, .sma2check = 20, .weeks2check = 0 },
+	{ .name = "check-50dup", .title = "SMA50d Up",
+	  .check_func = symbol_check_sma_up, .sma2check = 50, .weeks2check = 0 },
+	{ .name = "check-200dup", .title = "SMA200d Up",
+	  .check_func = symbol_check_weeks_low_sma, .sma2check = 200, .weeks2check = 0 },
+	{ .name = "check-20dpb", .title = "SMA20d PullBack",
+	  .check_func = symbol_check_sma_pullback, .sma2check = 20, .weeks2check = 0 },
+	{ .name = "check-50dpb", .title = "SMA50d PullBack",
+	  .check_func = symbol_check_sma_pullback, .sma2check = 50, .weeks2check = 0 },
+	{ .name = "check-10d-bo", .title = "SMA10d BreakOut",
+	  .check_func = symbol_check_sma_breakout, .sma2check = 10, .weeks2check = 0 },
+	{ .name = "check-20d-bo", .title = "SMA20d BreakOut",
+	  .check_func = symbol_check_sma_breakout, .sma2check = 20, .weeks2check = 0 },
+	{ .name = "check-10d-trendup", .title = "SMA10d TrendUp",
+	  .check_func = symbol_check_sma_trendup, .sma2check = 10, .weeks2check = 0 },
+	{ .name = "check-db", .title = "Double Bottom",
+	  .check_func = symbol_check_doublebottom, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-mfi-db", .title = "MFI Double Bottom",
+	  .check_func = symbol_check_mfi_doublebottom, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-pullback-db", .title = "PullBack Double Bottom",
+	  .check_func = symbol_check_pullback_doublebottom, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-52w-db", .title = "52w Low Double Bottom",
+	  .check_func = symbol_check_52w_doublebottom, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-52w-dbup", .title = "52w Low Double Bottom Up",
+	  .check_func = symbol_check_52w_doublebottom_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-dbup", .title = "Double Bottom Up",
+	  .check_func = symbol_check_doublebottom_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-pullback-dbup", .title = "PullBack Double Bottom Up",
+	  .check_func = symbol_check_pullback_doublebottom_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-strong-dbup", .title = "Strong Double Bottom Up",
+	  .check_func = symbol_check_strong_doublebottom_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-pb", .title = "PullBack",
+	  .check_func = symbol_check_pullback, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-bo", .title = "BreakOut",
+	  .check_func = symbol_check_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-2ndbo", .title = "2nd BreakOut",
+	  .check_func = symbol_check_2nd_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-52wlup", .title = "52w Low Up",
+	  .check_func = symbol_check_52w_low_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-chg", .title = "Change",
+	  .check_func = symbol_check_change, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-trend-bo", .title = "Trend BreakOut",
+	  .check_func = symbol_check_trend_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-strong-uptrend", .title = "Strong UpTrend",
+	  .check_func = symbol_check_strong_uptrend, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-strong-bo", .title = "Strong BreakOut",
+	  .check_func = symbol_check_strong_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-strong-body-bo", .title = "Strong Body BreakOut",
+	  .check_func = symbol_check_strong_body_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-resist-bo", .title = "Resist BreakOut",
+	  .check_func = symbol_check_resist_breakout, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-mfi", .title = "MFI",
+	  .check_func = symbol_check_mfi, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-reverse-up", .title = "Reverse Up",
+	  .check_func = symbol_check_reverse_up, .sma2check = 0, .weeks2check = 0 },
+	{ .name = "check-higher-low", .title = "Higher Low",
+	  .check_func = symbol_check_higher_low, .sma2check = 0, .weeks2check = 0 },
+};
 
-	if (days_below_sma20 >= 0 && days_below_sma20 <= 4
-	    && (price2check->close > yesterday->sma[SMA_20d] && (price2check->low < yesterday->sma[SMA_20d] || yesterday->close < yesterday->sma[SMA_20d])))
-	{
-		anna_info("%s%-10s%s: date=%s, days_below_sma20=%d, %s; %s<sector=%s>%s.\n",
-			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-			price2check->date, days_below_sma20, get_price_volume_change(price_history, price2check),
-			ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
-		selected_symbol_nr += 1;
+#define CHECK_SCREEN_NR	(int)(sizeof(check_screens) / sizeof(check_screens[0]))
+
+/* index of the screen called name in check_screens[], -1 if there is none */
+int stock_price_screen_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < CHECK_SCREEN_NR; i++) {
+		if (strcmp(check_screens[i].name, name) == 0)
+			return i;
 	}
+
+	return -1;
 }
 
-static void __symbol_check_strong_breakout(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check, int strong_body)
+/* output of a symbol by a screen */
+struct check_output
 {
-#define STRONG_BO_MAX_DAYS   5
-	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
-	const struct date_price *yesterday = NULL;
-	uint32_t price2check_2ndlow = get_2ndlow(price2check);
-	uint32_t low_40day = price2check_2ndlow;
-	uint32_t high_40day = price2check_2ndhigh;
-	int i, j;
-
-	/* must be bull trend bar */
-	if (price2check->candle_trend == CANDLE_TREND_BEAR && price2check->close < price2check->open)
-		return;
+	char *buf;
+	size_t len;
+	int selected_nr;
+};
 
-	for (i = j = 0; i < price_history->date_cnt && j < 40; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) > 0) {
-			if (prev->volume == 0)
-				continue;
+/* a symbol of a group, members[] are in the order the group lists them */
+struct check_member
+{
+	int job;
+	char sector[48]; /* in the group, if has_sector */
+	int has_sector;
+	struct check_output output[CHECK_SCREEN_MAX]; /* by each screen of the group */
+};
 
-			if (yesterday == NULL) {
-				yesterday = prev;
-				/* if not strong_body, volume needs be enough */
-				if (!strong_body && price2check->volume < prev->vma[VMA_20d])
-					return;
-				if (strong_body && ((uint64_t)price2check->volume * 100) < ((uint64_t)prev->vma[VMA_20d] * 75))
-					return;
-				if (price2check->close <= prev->close
-				    || (price2check->close - prev->close) * 1000 / prev->close < 20)
-					return;
-			}
+/* a group of a check and the screens its symbols are run by */
+struct check_scan
+{
+	const struct check_group *group;
+	const struct check_screen *screens[CHECK_SCREEN_MAX];
+	int screen_nr;
+	struct price_pack pack; /* mapped if the group's symbols are read from it */
+	struct price_db *db; /* open if they are read from the group's database */
 
-			uint32_t prev_2ndhigh = get_2ndhigh(prev);
-			uint32_t prev_2ndlow = get_2ndlow(prev);
+	struct check_member *members;
+	int member_nr;
+	int member_max;
+};
 
-			if (prev_2ndlow < low_40day)
-				low_40day = prev_2ndlow;
+/*
+ * a distinct symbol of a check. with -jobs=N the symbols are taken in turn
+ * by N worker threads, each with its own history buffer. a symbol listed
+ * by several groups is read, and its caches computed, once for all of
+ * them, from the first group that lists it, as long as the groups' copies
+ * have as many bars up to the same latest date: a copy that differs is a
+ * job of its own. each group's sector is got as its symbols are listed,
+ * see struct check_peek. the output is kept, unless
+ * a single screen is run by a single thread, to be printed group by group
+ * and screen by screen in the order of the groups' symbols: the same as
+ * the output of a single thread running them one after the other.
+ */
+struct check_job
+{
+	char symbol[16];
+	int scan; /* the first group listing it, where it's read from */
+	char fname[256]; /* price file, "" if read from the pack or the database */
+	const struct price_pack_entry *entry; /* in the pack, NULL if not */
+	struct stock_price *history; /* read from the database beforehand, see check_scan_db() */
+	int borrowed; /* history is the group's, see struct check_group */
+	uint32_t date_cnt; /* of the copy read, with date, if the symbol may be shared */
+	uint32_t date; /* the latest, 0 if it's unknown and the job is not shared */
+	int member[CHECK_GROUP_MAX]; /* in each group's members[], -1 if it's not listed */
+	int done;
+};
 
-			if (prev_2ndhigh > high_40day)
-				high_40day = prev_2ndhigh;
+/*
+ * a group's copy of a symbol, got without reading its bars when the check
+ * has several groups: whether it's the copy of a job, and its sector.
+ */
+struct check_peek
+{
+	char sector[48];
+	uint32_t date_cnt;
+	uint32_t date; /* the latest, 0 if it's unknown */
+};
 
-			j += 1;
-		}
-	}
+struct check_pool
+{
+	uint32_t date;
+	int by_group; /* stock_price_check_groups() */
+	int keep_output;
 
-	if (high_40day == price2check_2ndhigh
-	    || (price2check_2ndlow > low_40day && (price2check_2ndlow - low_40day) * 100 / low_40day > 10))
-		return;
+	struct check_scan scans[CHECK_GROUP_MAX];
+	int scan_nr;
 
-	if (strong_body) {
-		uint64_t body_size;
+	struct check_job *jobs;
+	int job_nr;
+	int job_max;
+	int next_job; /* the first one not taken by a worker */
 
-		if (price2check->candle_trend == CANDLE_TREND_DOJI)
-			return;
+	int *slots; /* jobs by the hash of their symbol, -1 if free */
+	int slot_nr;
 
-                if (price2check->close >= price2check->open)
-                        body_size = price2check->close - price2check->open;
-                else
-                        body_size = price2check->open - price2check->close;
+	pthread_mutex_t lock;
+	pthread_cond_t job_done;
+};
 
-		if (body_size * 1000 / price2check->open < 10) /* body size >= 1% */
-			return;
-	}
+/*
+ * check the symbol of job by every screen of the groups that list it,
+ * ctx[] are their contexts, CHECK_SCREEN_MAX by group. the caches and the
+ * day to check are got once for all.
+ */
+static int call_check_funcs(const struct check_pool *pool, struct check_ctx *ctx, const struct check_job *job,
+			    struct stock_price *price_history)
+{
+	struct date_price price2check;
+	char sector[sizeof(price_history->sector)];
+	int yesterday_idx;
+	int s, k;
 
-	for (i = j = 0; i < price_history->date_cnt && j < STRONG_BO_MAX_DAYS; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) > 0) {
-			if (prev->volume == 0)
-				continue;
+	/* for stock_price_sma(), stock_price_range() and co. */
+	if (stock_price_sums(price_history) < 0 || stock_price_ranges(price_history) < 0
+	    || stock_price_levels(price_history) < 0 || stock_price_patterns(price_history) < 0)
+		return -1;
 
-			uint64_t prev_2ndhigh = get_2ndhigh(prev);
-			uint64_t price2check_2ndlow = get_2ndlow(price2check);
-			if (price2check_2ndhigh < prev->high
-			    || (prev_2ndhigh > price2check_2ndlow
-				&& (prev_2ndhigh - price2check_2ndlow) * 10000 / prev_2ndhigh >= 70))
-			{
-				break;
-			}
-			j += 1;
-		}
+	yesterday_idx = get_stock_price2check(job->symbol, pool->date, price_history, &price2check);
+	if (yesterday_idx < 0) {
+		//anna_error("%s: get_stock_price2check(%u)\n", symbol, date);
+		return -1;
 	}
 
-	if (j < STRONG_BO_MAX_DAYS)
-		return;
-
-	anna_info("%s%-10s%s: date=%s, %s; %s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, get_price_volume_change(price_history, price2check),
-		price_history->sector);
+	strlcpy(sector, price_history->sector, sizeof(sector));
 
-	selected_symbol_nr += 1;
-}
+	for (s = 0; s < pool->scan_nr; s++) {
+		const struct check_scan *scan = &pool->scans[s];
+		struct check_member *member;
 
-static void symbol_check_strong_breakout(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
-{
-	__symbol_check_strong_breakout(symbol, price_history, price2check, 0);
-}
+		if (job->member[s] < 0)
+			continue;
 
-static void symbol_check_strong_body_breakout(const char *symbol, const struct stock_price *price_history,
-						 const struct date_price *price2check)
-{
-	__symbol_check_strong_breakout(symbol, price_history, price2check, 1);
-}
+		member = &scan->members[job->member[s]];
 
-static void symbol_check_resist_breakout(const char *symbol, const struct stock_price *price_history,
-					 const struct date_price *price2check)
-{
-	const struct date_price *yesterday;
-	int i, j, matched_date = 0;
-	uint32_t yesterday_2ndlow;
-	uint32_t price2check_2ndhigh = get_2ndhigh(price2check);
+		strlcpy(price_history->sector, member->has_sector ? member->sector : sector, sizeof(price_history->sector));
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0)
-			break;
+		for (k = 0; k < scan->screen_nr; k++)
+			scan->screens[k]->check_func(&ctx[s * CHECK_SCREEN_MAX + k], job->symbol, price_history, &price2check, yesterday_idx);
 	}
 
-	if (price2check->volume * 100 < yesterday->vma[VMA_20d] * 115)
-		return;
+	/* a history kept in memory is checked again */
+	strlcpy(price_history->sector, sector, sizeof(price_history->sector));
 
-	i += 1;
+	return 0;
+}
 
-	if (i == price_history->date_cnt)
-		return;
+/* job's price file, mapped into the worker's price_history as a pack entry is viewed */
+static int call_check_funcs_file(const struct check_pool *pool, struct check_ctx *ctx, const struct check_job *job,
+				 struct stock_price *price_history)
+{
+	if (stock_price_map_file(job->fname, price_history) < 0) {
+		anna_error("stock_price_map_file(%s) failed\n", job->fname);
+		return -1;
+	}
 
-	yesterday_2ndlow = get_2ndlow(yesterday);
+	return call_check_funcs(pool, ctx, job, price_history);
+}
 
-	for (j = 0; j < 250 && i < price_history->date_cnt; i++, j++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		uint32_t prev_2ndhigh = get_2ndhigh(prev);
+static unsigned int symbol_hash(const char *symbol)
+{
+	unsigned int hash = 2166136261u;
 
-		if (prev_2ndhigh >= price2check_2ndhigh)
-			break;
+	while (*symbol)
+		hash = (hash ^ (unsigned char)*symbol++) * 16777619;
 
-		if (!is_resist(prev->sr_flag));
-			continue;
+	return hash;
+}
 
-		if (prev->sr_flag & SR_F_RESIST_HIGH) {
-			if (price2check->close > prev->high
-			    && (price2check->low < prev->high || yesterday_2ndlow < prev->high))
-				matched_date += 1;
-		}
-		else if (prev->sr_flag & SR_F_RESIST_HIGH) {
-			if (price2check->close > prev_2ndhigh
-			    && (price2check->low < prev_2ndhigh || yesterday_2ndlow < prev_2ndhigh))
-				matched_date += 1;
-		}
+/* the job of symbol, of the same copy as peek if it's set, -1 if it has none */
+static int check_pool_find(const struct check_pool *pool, const char *symbol, const struct check_peek *peek)
+{
+	const struct check_job *job;
+	unsigned int i;
+
+	if (!pool->slot_nr)
+		return -1;
+
+	for (i = symbol_hash(symbol) & (pool->slot_nr - 1); pool->slots[i] >= 0; i = (i + 1) & (pool->slot_nr - 1)) {
+		job = &pool->jobs[pool->slots[i]];
+
+		if (strcmp(job->symbol, symbol))
+			continue;
+
+		if (!peek || (peek->date && peek->date == job->date && peek->date_cnt == job->date_cnt))
+			return pool->slots[i];
 	}
 
-	if (matched_date < 2)
-		return;
+	return -1;
+}
 
-	anna_info("%s%-10s%s: date=%s, matched_date=%d, %s; %s.\n",
-		ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		price2check->date, matched_date, get_price_volume_change(price_history, price2check),
-		price_history->sector);
+static void check_pool_slot(struct check_pool *pool, int job)
+{
+	unsigned int i = symbol_hash(pool->jobs[job].symbol) & (pool->slot_nr - 1);
 
-	selected_symbol_nr += 1;
+	while (pool->slots[i] >= 0)
+		i = (i + 1) & (pool->slot_nr - 1);
 
+	pool->slots[i] = job;
 }
 
-static void symbol_check_mfi(const char *symbol, const struct stock_price *price_history,
-				 const struct date_price *price2check)
+/* hash job, the slots are kept at most half used */
+static int check_pool_hash(struct check_pool *pool, int job)
 {
-	const struct date_price *yesterday, *prev_20d;
-	int i;
+	if ((job + 1) * 2 > pool->slot_nr) {
+		int slot_nr = pool->slot_nr ? pool->slot_nr * 2 : 512;
+		int *slots = malloc(sizeof(*slots) * slot_nr);
+		int i;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
-		if (strcmp(price2check->date, yesterday->date) > 0) {
-			prev_20d = yesterday + 20;
-			break;
+		if (!slots) {
+			anna_error("malloc(%zu) failed\n", sizeof(*slots) * slot_nr);
+			return -1;
 		}
-	}
 
-	if (yesterday->mfi > prev_20d->mfi && prev_20d->mfi
-	    && (yesterday->mfi - prev_20d->mfi) * 100 / (prev_20d->mfi >= 0 ? prev_20d->mfi : -prev_20d->mfi) >= 25
-	    && yesterday->close < prev_20d->close
-	    && price2check->volume * 100 / yesterday->vma[VMA_20d] <= 60)
-	{
-		anna_info("%s%-10s%s: date=%s, %s; %s.\n",
-				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-				price2check->date, get_price_volume_change(price_history, price2check),
-				price_history->sector);
+		free(pool->slots);
+		pool->slots = slots;
+		pool->slot_nr = slot_nr;
 
-		selected_symbol_nr += 1;
+		for (i = 0; i < slot_nr; i++)
+			slots[i] = -1;
+		for (i = 0; i < job; i++)
+			check_pool_slot(pool, i);
 	}
+
+	check_pool_slot(pool, job);
+
+	return 0;
 }
 
-static void symbol_check_reverse_up(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
+/*
+ * symbol's member of group s, and its job if it's the first group that
+ * lists this copy of it: job->scan is s then, the caller sets where it's
+ * read from. peek is the group's copy if the check has several groups,
+ * NULL if not.
+ */
+static struct check_member *check_pool_add(struct check_pool *pool, int s, const char *symbol,
+					   const struct check_peek *peek)
 {
+	struct check_scan *scan = &pool->scans[s];
+	struct check_member *member;
+	struct check_job *job;
+	int j = check_pool_find(pool, symbol, peek);
 	int i;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *yesterday = &price_history->dateprice[i];
+	if (j < 0) {
+		if (pool->job_nr == pool->job_max) {
+			int job_max = pool->job_max ? pool->job_max * 2 : 256;
 
-		if (strcmp(price2check->date, yesterday->date) <= 0)
-			continue;
+			job = realloc(pool->jobs, sizeof(*job) * job_max);
+			if (!job) {
+				anna_error("realloc(%zu) failed\n", sizeof(*job) * job_max);
+				return NULL;
+			}
 
-		if (yesterday->volume * 100 < yesterday->vma[VMA_20d] * 120
-		    || yesterday->close > (yesterday+1)->high
-		    || price2check->close < yesterday->high
-		    || price2check->close < (yesterday+1)->high)
-			return;
+			pool->jobs = job;
+			pool->job_max = job_max;
+		}
 
-		if (/*((yesterday+1)->candle_color == CANDLE_COLOR_RED && yesterday->candle_color == CANDLE_COLOR_GREEN)
-		    ||*/ ((yesterday+1)->candle_color == CANDLE_COLOR_GREEN && yesterday->candle_color == CANDLE_COLOR_RED))
-		{
-			anna_info("%s%-10s%s: date=%s, %s; %s.\n",
-				ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-				price2check->date, get_price_volume_change(price_history, price2check),
-				price_history->sector);
+		j = pool->job_nr;
+
+		job = &pool->jobs[j];
+		memset(job, 0, sizeof(*job));
+		strlcpy(job->symbol, symbol, sizeof(job->symbol));
+		job->scan = s;
+		if (peek) {
+			job->date_cnt = peek->date_cnt;
+			job->date = peek->date;
+		}
+		for (i = 0; i < CHECK_GROUP_MAX; i++)
+			job->member[i] = -1;
+
+		if (check_pool_hash(pool, j) < 0)
+			return NULL;
+
+		pool->job_nr += 1;
+	}
 
-			selected_symbol_nr += 1;
+	job = &pool->jobs[j];
 
+	/* listed twice */
+	if (job->member[s] >= 0)
+		return &scan->members[job->member[s]];
+
+	if (scan->member_nr == scan->member_max) {
+		int member_max = scan->member_max ? scan->member_max * 2 : 256;
+
+		member = realloc(scan->members, sizeof(*member) * member_max);
+		if (!member) {
+			anna_error("realloc(%zu) failed\n", sizeof(*member) * member_max);
+			return NULL;
 		}
-		break;
+
+		scan->members = member;
+		scan->member_max = member_max;
 	}
-}
 
-static void symbol_check_52w_low_up(const char *symbol, const struct stock_price *price_history,
-				    const struct date_price *price2check)
-{
-	const struct date_price *yesterday = NULL;
-	uint32_t price2check_2ndlow = get_2ndlow(price2check);
-	uint32_t yesterday_2ndlow;
-	uint32_t is_52w_low = 1, is_52w_2ndlow = 1;
-	int i, j;
+	member = &scan->members[scan->member_nr];
+	memset(member, 0, sizeof(*member));
+	member->job = j;
+	if (peek) {
+		strlcpy(member->sector, peek->sector, sizeof(member->sector));
+		member->has_sector = 1;
+	}
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		yesterday = &price_history->dateprice[i];
+	job->member[s] = scan->member_nr++;
 
-		if (strcmp(price2check->date, yesterday->date) <= 0)
-			continue;
+	return member;
+}
 
-		yesterday_2ndlow = get_2ndlow(yesterday);
+static void check_job_run(const struct check_pool *pool, struct check_ctx *ctx, struct check_job *job,
+			  struct stock_price *price_history)
+{
+	int s, k;
 
-		if (price2check->low < yesterday->low && price2check_2ndlow < yesterday_2ndlow) {
-			is_52w_low = is_52w_2ndlow = 0;
-			break;
-		}
+	for (s = 0; s < pool->scan_nr; s++) {
+		struct check_member *member = job->member[s] >= 0 ? &pool->scans[s].members[job->member[s]] : NULL;
 
-		for (j = i + 1; j < price_history->date_cnt && (j - i) <= 250; j++) {
-			const struct date_price *prev = &price_history->dateprice[j];
+		for (k = 0; member && k < pool->scans[s].screen_nr; k++) {
+			struct check_ctx *c = &ctx[s * CHECK_SCREEN_MAX + k];
 
-			if (prev->low < yesterday->low)
-				is_52w_low = 0;
-			if (get_2ndlow(prev) < yesterday_2ndlow)
-				is_52w_2ndlow = 0;
+			c->selected_nr = 0;
+			c->out = stdout;
 
-			if (!is_52w_low && !is_52w_2ndlow)
-				break;
+			/* stdout, out of order, if the output can't be kept */
+			if (pool->keep_output) {
+				c->out = open_memstream(&member->output[k].buf, &member->output[k].len);
+				if (!c->out)
+					c->out = stdout;
+			}
 		}
+	}
 
-		break;
+	if (job->fname[0])
+		call_check_funcs_file(pool, ctx, job, price_history);
+	else if (job->entry) {
+		price_pack_view(&pool->scans[job->scan].pack, job->entry, price_history);
+		call_check_funcs(pool, ctx, job, price_history);
 	}
+	else if (job->history) {
+		if (job->history->date_cnt)
+			call_check_funcs(pool, ctx, job, job->history);
+	}
+	else if (price_db_read(pool->scans[job->scan].db, job->symbol, price_history) < 0)
+		anna_error("%s is not found in %s.db\n", job->symbol, pool->scans[job->scan].group->name);
+	else
+		call_check_funcs(pool, ctx, job, price_history);
 
-	if ((is_52w_low || is_52w_2ndlow)
-	    && (get_2ndhigh(price2check) > get_2ndhigh(yesterday)
-	        || (price2check->low >= yesterday->low && price2check_2ndlow >= yesterday_2ndlow))
-	   )
-	{
-		anna_info("%s%-10s%s: date=%s, %s, is up from 52w low date=%s.\n",
-			ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, price2check->date,
-			get_price_volume_change(price_history, price2check), yesterday->date);
+	for (s = 0; s < pool->scan_nr; s++) {
+		struct check_member *member = job->member[s] >= 0 ? &pool->scans[s].members[job->member[s]] : NULL;
+
+		for (k = 0; member && k < pool->scans[s].screen_nr; k++) {
+			struct check_ctx *c = &ctx[s * CHECK_SCREEN_MAX + k];
 
-		selected_symbol_nr += 1;
+			if (c->out != stdout)
+				fclose(c->out);
+
+			member->output[k].selected_nr = c->selected_nr;
+		}
 	}
 }
 
-static void get_52w_low(const struct stock_price *price_history, const struct date_price *price2check,
-			uint32_t *low, uint32_t *second_low)
+static void *check_worker(void *arg)
 {
-	int i, count;
+	struct check_pool *pool = arg;
+	struct check_ctx ctx[CHECK_GROUP_MAX * CHECK_SCREEN_MAX] = { };
+	struct stock_price price_history = { };
+	struct check_job *job;
+	int s, k;
 
-	*low = *second_low = (uint32_t)-1;
+	for (s = 0; s < pool->scan_nr; s++) {
+		for (k = 0; k < pool->scans[s].screen_nr; k++) {
+			struct check_ctx *c = &ctx[s * CHECK_SCREEN_MAX + k];
 
-	for (i = 0, count = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
+			c->params = &pool->scans[s].group->params;
+			c->sma2check = pool->scans[s].screens[k]->sma2check;
+			c->weeks2check = pool->scans[s].screens[k]->weeks2check;
+		}
+	}
 
-		if (strcmp(price2check->date, prev->date) <= 0)
-			continue;
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		job = pool->next_job < pool->job_nr ? &pool->jobs[pool->next_job++] : NULL;
+		pthread_mutex_unlock(&pool->lock);
 
-		if (count >= 250)
+		if (!job)
 			break;
 
-		count += 1;
+		check_job_run(pool, ctx, job, &price_history);
 
-		if (prev->low < *low)
-			*low = prev->low;
-		if (get_2ndlow(prev) < *second_low)
-			*second_low = get_2ndlow(prev);
+		pthread_mutex_lock(&pool->lock);
+		job->done = 1;
+		pthread_cond_broadcast(&pool->job_done);
+		pthread_mutex_unlock(&pool->lock);
 	}
+
+	stock_price_free(&price_history);
+
+	return NULL;
 }
 
-static int near_52w_low(const struct date_price *price2check, uint32_t low_52w, uint32_t second_low_52w)
+/* the output of every group and screen, as the jobs are done, then its number of symbols selected */
+static void check_pool_print(struct check_pool *pool)
 {
-	uint32_t diff;
-	uint32_t price2check_2ndlow;
+	int s, i, k;
 
-	if (price2check->low > low_52w)
-		diff = price2check->low - low_52w;
-	else
-		diff = low_52w - price2check->low;
-	if (diff * 1000 / low_52w <= 50)
-		return 1;
+	for (s = 0; s < pool->scan_nr; s++) {
+		struct check_scan *scan = &pool->scans[s];
 
-	if (price2check->low > second_low_52w)
-		diff = price2check->low - second_low_52w;
-	else
-		diff = second_low_52w - price2check->low;
-	if (diff * 1000 / second_low_52w <= 50)
-		return 1;
+		if (pool->by_group)
+			anna_info("group=%s\n", scan->group->name);
 
-	price2check_2ndlow = get_2ndlow(price2check);
+		for (k = 0; k < scan->screen_nr; k++) {
+			int selected_nr = 0;
 
-	if (price2check_2ndlow > low_52w)
-		diff = price2check_2ndlow - low_52w;
-	else
-		diff = low_52w - price2check_2ndlow;
-	if (diff * 1000 / low_52w <= 50)
-		return 1;
+			if (scan->screen_nr > 1)
+				anna_info("\n%s%s%s:\n\n", ANSI_COLOR_YELLOW, scan->screens[k]->title, ANSI_COLOR_RESET);
 
-	if (price2check_2ndlow > second_low_52w)
-		diff = price2check_2ndlow - second_low_52w;
-	else
-		diff = second_low_52w - price2check_2ndlow;
-	if (diff * 1000 / second_low_52w <= 50)
-		return 1;
+			for (i = 0; i < scan->member_nr; i++) {
+				struct check_output *output = &scan->members[i].output[k];
+				struct check_job *job = &pool->jobs[scan->members[i].job];
 
-	return 0;
+				pthread_mutex_lock(&pool->lock);
+				while (!job->done)
+					pthread_cond_wait(&pool->job_done, &pool->lock);
+				pthread_mutex_unlock(&pool->lock);
+
+				if (output->len) {
+					fwrite(output->buf, 1, output->len, stdout);
+					fflush(stdout);
+				}
+
+				free(output->buf);
+				output->buf = NULL;
+
+				selected_nr += output->selected_nr;
+			}
+
+			anna_info("%s%d%s symbols are selected.\n", ANSI_COLOR_YELLOW, selected_nr, ANSI_COLOR_RESET);
+		}
+
+		if (pool->by_group)
+			anna_info("\n");
+	}
 }
 
-static void symbol_check_52w_doublebottom(const char *symbol, const struct stock_price *price_history,
-					const struct date_price *price2check)
+/*
+ * run the jobs of pool by thread_nr threads and print their output. the
+ * jobs are taken one at a time as the threads are free, so a thread
+ * done with cheap symbols takes over the rest.
+ */
+static void check_pool_run(struct check_pool *pool, int thread_nr)
 {
-	struct stock_support sspt = { };
+	int worker_nr = thread_nr < pool->job_nr ? thread_nr : pool->job_nr;
+	pthread_t *workers = NULL;
 	int i;
 
-	check_support(price_history, price2check, &sspt);
+	if (worker_nr <= 1)
+		worker_nr = 0;
 
-	if (!sspt.date_nr)
-		return;
-
-	for (i = 0; i < sspt.date_nr; i++) {
-		if (sspt.is_doublebottom[i]) {
-			uint32_t low_52w, second_low_52w;
+	pool->keep_output = worker_nr || pool->scan_nr > 1 || pool->scans[0].screen_nr > 1;
 
-			get_52w_low(price_history, price2check, &low_52w, &second_low_52w);
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->job_done, NULL);
 
-			if (near_52w_low(price2check, low_52w, second_low_52w)) {
-				anna_info("%s%-10s%s: date=%s, %s; is double bottom with dates=%s; %s<sector=%s>%s.\n",
-					ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET, price2check->date,
-					get_price_volume_change(price_history, price2check), sspt.date[i],
-					ANSI_COLOR_YELLOW, price_history->sector, ANSI_COLOR_RESET);
+	if (worker_nr) {
+		workers = calloc(worker_nr, sizeof(*workers));
+		if (!workers) {
+			anna_error("calloc(%zu) failed\n", sizeof(*workers) * worker_nr);
+			worker_nr = 0;
+		}
+	}
 
-				selected_symbol_nr += 1;
-			}
+	for (i = 0; i < worker_nr; i++) {
+		int rt = pthread_create(&workers[i], NULL, check_worker, pool);
 
+		if (rt) {
+			anna_error("pthread_create failed: %d(%s)\n", rt, strerror(rt));
+			worker_nr = i;
 			break;
 		}
 	}
+
+	/* a single thread, or none is started: the jobs are run here */
+	if (!worker_nr)
+		check_worker(pool);
+
+	check_pool_print(pool);
+
+	for (i = 0; i < worker_nr; i++)
+		pthread_join(workers[i], NULL);
+
+	pthread_cond_destroy(&pool->job_done);
+	pthread_mutex_destroy(&pool->lock);
+	free(workers);
 }
 
-static void symbol_check_52w_doublebottom_up(const char *symbol, const struct stock_price *price_history,
-                                        const struct date_price *price2check)
+/* the symbols in the group's database, or symbols, read by the jobs through scan->db */
+static int check_scan_db(struct check_pool *pool, int s, int symbols_nr, const char **symbols)
 {
-	int i, cnt = 0;
+	struct check_scan *scan = &pool->scans[s];
+	struct check_peek peek;
+	char **db_symbols = NULL;
+	int db_symbols_nr = 0;
+	int i, rt = 0;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		const struct date_price *prev = &price_history->dateprice[i];
-		if (strcmp(prev->date, price2check->date) >= 0)
-			continue;
+	scan->db = price_db_open(scan->group->name);
+	if (!scan->db)
+		return -1;
 
-		if (cnt >= 2)
-			break;
+	if (!symbols_nr) {
+		db_symbols_nr = price_db_symbols(scan->db, &db_symbols);
+		if (db_symbols_nr < 0)
+			db_symbols_nr = 0;
 
-		cnt += 1;
+		symbols_nr = db_symbols_nr;
+		symbols = (const char **)db_symbols;
+	}
 
-		if (price2check->close < prev->close)
+	for (i = 0; i < symbols_nr; i++) {
+		if (pool->scan_nr > 1) {
+			if (price_db_peek(scan->db, symbols[i], peek.sector, sizeof(peek.sector),
+					  &peek.date_cnt, &peek.date) < 0)
+				continue;
+		}
+		else if (pool->by_group && !price_db_has_symbol(scan->db, symbols[i]))
 			continue;
 
-		int saved = selected_symbol_nr;
-
-		symbol_check_52w_doublebottom(symbol, price_history, price2check);
-
-		if (selected_symbol_nr > saved)
+		if (!check_pool_add(pool, s, symbols[i], pool->scan_nr > 1 ? &peek : NULL)) {
+			rt = -1;
 			break;
+		}
 	}
+
+	for (i = 0; i < db_symbols_nr; i++)
+		free(db_symbols[i]);
+	free(db_symbols);
+
+	return rt;
 }
 
-static void symbol_check_change(const char *symbol, const struct stock_price *price_history,
-				const struct date_price *price2check)
+/* the symbols in the group's pack, or symbols */
+static int check_scan_pack(struct check_pool *pool, int s, int symbols_nr, const char **symbols)
 {
-	const struct date_price *prev;
+	struct check_scan *scan = &pool->scans[s];
+	const struct price_pack_entry *entry;
+	struct check_member *member;
+	struct check_peek peek;
+	struct check_job *job;
 	int i;
 
-	for (i = 0; i < price_history->date_cnt; i++) {
-		prev = &price_history->dateprice[i];
-		if (strcmp(price2check->date, prev->date) > 0)
-			break;
+	for (i = 0; i < (symbols_nr ? symbols_nr : scan->pack.symbol_nr); i++) {
+		if (symbols_nr) {
+			entry = price_pack_find(&scan->pack, symbols[i]);
+			if (!entry) {
+				if (!pool->by_group)
+					anna_error("%s is not found in %s.pack\n", symbols[i], scan->group->name);
+				continue;
+			}
+		}
+		else
+			entry = &scan->pack.entries[i];
+
+		strlcpy(peek.sector, entry->sector, sizeof(peek.sector));
+		peek.date_cnt = entry->date_cnt;
+		peek.date = entry->date_cnt ? ((const struct date_price *)((char *)scan->pack.map_addr + entry->offset))->date : 0;
+
+		member = check_pool_add(pool, s, entry->symbol, pool->scan_nr > 1 ? &peek : NULL);
+		if (!member)
+			return -1;
+
+		job = &pool->jobs[member->job];
+		if (job->scan == s)
+			job->entry = entry;
 	}
 
-	anna_info("%s%-10s%s: date=%s, %s.\n", ANSI_COLOR_YELLOW, symbol, ANSI_COLOR_RESET,
-		  price2check->date, get_price_volume_change(price_history, price2check));
+	return 0;
 }
 
-static int call_check_func(const char *symbol, const char *date, const char *fname,
-			    void (*check_func)(const char *, const struct stock_price *, const struct date_price *))
+/* symbol's price file fname, of group s */
+static int check_scan_file(struct check_pool *pool, int s, const char *symbol, const char *fname)
 {
-	struct stock_price price_history;
-	struct date_price price2check;
+	struct check_member *member;
+	struct check_peek peek;
+	struct check_job *job;
 
-	if (get_symbol_price_for_check(symbol, date, fname, &price_history, &price2check) < 0) {
-		//anna_error("get_symbol_price_for_check(symbol=%s,date=%s,fname=%s) failed\n", symbol, date, fname);
+	/* a file that can't be peeked is not shared, its job reports it */
+	if (pool->scan_nr > 1)
+		price_file_peek(fname, peek.sector, sizeof(peek.sector), &peek.date_cnt, &peek.date);
+
+	member = check_pool_add(pool, s, symbol, pool->scan_nr > 1 ? &peek : NULL);
+	if (!member)
 		return -1;
-	}
 
-	check_func(symbol, &price_history, &price2check);
+	job = &pool->jobs[member->job];
+	if (job->scan == s)
+		strlcpy(job->fname, fname, sizeof(job->fname));
 
 	return 0;
 }
 
-static void stock_price_check(const char *group, const char *date, int symbols_nr, const char **symbols,
-				void (*check_func)(const char *symbol, const struct stock_price *price_history, const struct date_price *price2check))
+/* the price files of the group, or of symbols */
+static int check_scan_files(struct check_pool *pool, int s, int symbols_nr, const char **symbols)
 {
-
-	char path[128];
-	char fname[256];
+	struct check_scan *scan = &pool->scans[s];
+	char path[128], fname[256];
 	int i;
 
-	snprintf(path, sizeof(path), "%s/%s", ROOT_DIR, group);
-
-	selected_symbol_nr = 0;
+	snprintf(path, sizeof(path), "%s/%s", ROOT_DIR, scan->group->name);
 
 	if (symbols_nr) {
 		for (i = 0; i < symbols_nr; i++) {
 			snprintf(fname, sizeof(fname), "%s/%s.price", path, symbols[i]);
 
-			call_check_func(symbols[i], date, fname, check_func);
+			/* a symbol may be listed by some of the groups only */
+			if (pool->by_group && access(fname, F_OK) < 0)
+				continue;
+
+			if (check_scan_file(pool, s, symbols[i], fname) < 0)
+				return -1;
 		}
 	}
 	else {
 		DIR *dir = opendir(path);
 		if (!dir) {
 			anna_error("opendir(%s) failed: %d(%s)\n", path, errno, strerror(errno));
-			return;
+			return -1;
 		}
 
 		struct dirent *de;
 
 		while ((de = readdir(dir))) {
-			char symbol[16];
-			char *p;
+			char symbol[16], *p;
 
 			if (de->d_name[0] == '.')
 				continue;
 
+			if (snprintf(fname, sizeof(fname), "%s/%s", path, de->d_name) >= sizeof(fname)) {
+				anna_error("%s/%s: file name is too long\n", path, de->d_name);
+				continue;
+			}
+
 			strlcpy(symbol, de->d_name, sizeof(symbol));
 			p = strstr(symbol, ".price");
 			if (p)
 				*p = 0;
 
-			snprintf(fname, sizeof(fname), "%s/%s", path, de->d_name);
-
-			call_check_func(symbol, date, fname, check_func);
+			if (check_scan_file(pool, s, symbol, fname) < 0) {
+				closedir(dir);
+				return -1;
+			}
 		}
 
 		closedir(dir);
 	}
 
-	anna_info("%s%d%s symbols are selected.\n", ANSI_COLOR_YELLOW, selected_symbol_nr, ANSI_COLOR_RESET);
+	return 0;
 }
 
-void stock_price_check_support(const char *group, const char *date, int symbols_nr, const char **symbols)
+/* the histories kept in memory for the group, or those of symbols */
+static int check_scan_histories(struct check_pool *pool, int s, int symbols_nr, const char **symbols)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_support);
-}
+	const struct check_group *group = pool->scans[s].group;
+	const struct stock_price *history;
+	struct check_member *member;
+	struct check_peek peek;
+	struct check_job *job;
+	int i, h;
 
-void stock_price_check_sma(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_support);
-	sma2check = -1;
-}
+	for (i = 0; i < (symbols_nr ? symbols_nr : group->history_nr); i++) {
+		if (symbols_nr) {
+			for (h = 0; h < group->history_nr; h++) {
+				if (strcmp(group->history_symbols[h], symbols[i]) == 0)
+					break;
+			}
 
-void stock_price_check_weeks_low_sma(const char *group, const char *date, int weeks, int sma_idx, int symbols_nr, const char **symbols)
-{
-	weeks2check = weeks;
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_weeks_low_sma);
-	sma2check = -1;
-	weeks2check = 0;
-}
+			if (h == group->history_nr) {
+				if (!pool->by_group)
+					anna_error("%s is not found in group %s\n", symbols[i], group->name);
+				continue;
+			}
+		}
+		else
+			h = i;
 
-void stock_price_check_sma_pullback(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_sma_pullback);
-	sma2check = -1;
-}
+		history = group->histories[h];
 
-void stock_price_check_sma_breakout(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_sma_breakout);
-	sma2check = -1;
-}
+		strlcpy(peek.sector, history->sector, sizeof(peek.sector));
+		peek.date_cnt = history->date_cnt;
+		peek.date = history->date_cnt ? history->dateprice[0].date : 0;
 
-void stock_price_check_sma_trendup(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_sma_trendup);
-	sma2check = -1;
-}
+		member = check_pool_add(pool, s, group->history_symbols[h], pool->scan_nr > 1 ? &peek : NULL);
+		if (!member)
+			return -1;
 
-void stock_price_check_strong_sma_up(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_strong_sma_up);
-	sma2check = -1;
-}
+		job = &pool->jobs[member->job];
+		if (job->scan == s) {
+			job->history = group->histories[h];
+			job->borrowed = 1;
+		}
+	}
 
-void stock_price_check_sma_up(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols)
-{
-	sma2check = sma_idx;
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_sma_up);
-	sma2check = -1;
+	return 0;
 }
 
-void stock_price_check_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols)
+/* add group, checked by its screens of check_screens[], as the next scan of pool */
+static void check_pool_scan(struct check_pool *pool, const struct check_group *group)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_doublebottom);
-}
+	struct check_scan *scan = &pool->scans[pool->scan_nr++];
+	int screen_nr = group->screen_nr;
+	int k;
 
-void stock_price_check_mfi_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_mfi_doublebottom);
-}
+	if (screen_nr > CHECK_SCREEN_MAX) {
+		anna_error("%d screens, up to %d are run at once\n", screen_nr, CHECK_SCREEN_MAX);
+		screen_nr = CHECK_SCREEN_MAX;
+	}
 
-void stock_price_check_pullback_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_pullback_doublebottom);
+	scan->group = group;
+	scan->screen_nr = screen_nr;
+	for (k = 0; k < screen_nr; k++)
+		scan->screens[k] = &check_screens[group->screens[k]];
 }
 
-void stock_price_check_52w_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols)
+/* the members of group s, read from its storage */
+static int check_scan_list(struct check_pool *pool, int s, int symbols_nr, const char **symbols)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_52w_doublebottom);
-}
+	struct check_scan *scan = &pool->scans[s];
 
-void stock_price_check_52w_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_52w_doublebottom_up);
-}
+	if (scan->group->histories)
+		return check_scan_histories(pool, s, symbols_nr, symbols);
 
-void stock_price_check_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_doublebottom_up);
-}
+	if (scan->group->storage == PRICE_STORAGE_SQLITE)
+		return check_scan_db(pool, s, symbols_nr, symbols);
 
-void stock_price_check_pullback_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_pullback_doublebottom_up);
-}
+	/* fall back to the price files if the pack is not built yet */
+	if (scan->group->storage == PRICE_STORAGE_PACK && price_pack_open(scan->group->name, &scan->pack) == 0)
+		return check_scan_pack(pool, s, symbols_nr, symbols);
 
-void stock_price_check_strong_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_strong_doublebottom_up);
+	return check_scan_files(pool, s, symbols_nr, symbols);
 }
 
-void stock_price_check_higher_low(const char *group, const char *date, int symbols_nr, const char **symbols)
+static void check_pool_free(struct check_pool *pool)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_higher_low);
-}
+	int s, i;
 
-void stock_price_check_pullback(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_pullback);
-}
+	for (s = 0; s < pool->scan_nr; s++) {
+		if (pool->scans[s].pack.map_addr)
+			price_pack_close(&pool->scans[s].pack);
+		price_db_close(pool->scans[s].db);
+		free(pool->scans[s].members);
+	}
 
-void stock_price_check_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_breakout);
-}
+	for (i = 0; i < pool->job_nr; i++) {
+		if (pool->jobs[i].history && !pool->jobs[i].borrowed) {
+			stock_price_free(pool->jobs[i].history);
+			free(pool->jobs[i].history);
+		}
+	}
 
-void stock_price_check_2nd_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_2nd_breakout);
+	free(pool->jobs);
+	free(pool->slots);
 }
 
-void stock_price_check_trend_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
+/*
+ * check the symbols of group, or symbols, by the group's screens of
+ * check_screens[], see stock_price_screen_find(). each symbol is read
+ * once for all of them, the output is printed screen by screen.
+ */
+void stock_price_check_screens(const struct check_group *group, const char *date, int symbols_nr, const char **symbols)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_trend_breakout);
-}
+	struct check_pool pool = { };
 
-void stock_price_check_strong_uptrend(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_strong_uptrend);
-}
+	if (stock_date_from_str(date, &pool.date) < 0) {
+		anna_error("invalid date='%s'\n", date);
+		return;
+	}
 
-void stock_price_check_strong_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_strong_breakout);
-}
+	check_pool_scan(&pool, group);
 
-void stock_price_check_strong_body_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_strong_body_breakout);
-}
+	if (check_scan_list(&pool, 0, symbols_nr, symbols) == 0)
+		check_pool_run(&pool, group->params.jobs);
 
-void stock_price_check_resist_breakout(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_resist_breakout);
+	check_pool_free(&pool);
 }
 
-void stock_price_check_mfi(const char *group, const char *date, int symbols_nr, const char **symbols)
+/*
+ * check every group of groups[] by its screens, by jobs threads, as
+ * stock_price_check_screens() would one after the other, with the name of
+ * the group ahead of its output. a symbol listed by several groups is read
+ * once for all of them, a group that can't be listed is checked as empty.
+ */
+void stock_price_check_groups(const char *date, int jobs, int group_nr, const struct check_group *groups,
+			      int symbols_nr, const char **symbols)
 {
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_mfi);
-}
+	struct check_pool pool = { };
+	int s;
 
-void stock_price_check_reverse_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_reverse_up);
-}
+	if (group_nr > CHECK_GROUP_MAX) {
+		anna_error("%d groups, up to %d are checked at once\n", group_nr, CHECK_GROUP_MAX);
+		group_nr = CHECK_GROUP_MAX;
+	}
 
-void stock_price_check_52w_low_up(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_52w_low_up);
-}
+	if (stock_date_from_str(date, &pool.date) < 0) {
+		anna_error("invalid date='%s'\n", date);
+		return;
+	}
 
-void stock_price_check_change(const char *group, const char *date, int symbols_nr, const char **symbols)
-{
-	stock_price_check(group, date, symbols_nr, symbols, symbol_check_change);
+	pool.by_group = 1;
+
+	for (s = 0; s < group_nr; s++)
+		check_pool_scan(&pool, &groups[s]);
+
+	for (s = 0; s < pool.scan_nr; s++)
+		check_scan_list(&pool, s, symbols_nr, symbols);
+
+	if (pool.scan_nr)
+		check_pool_run(&pool, jobs);
+
+	check_pool_free(&pool);
 }
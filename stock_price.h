@@ -53,64 +53,246 @@ enum
 #define is_support(sr_flag) (sr_flag & (SR_F_SUPPORT_LOW | SR_F_SUPPORT_2ndLOW))
 #define is_resist(sr_flag) (sr_flag &(SR_F_RESIST_HIGH | SR_F_RESIST_2ndHIGH))
 
+/*
+ * multi-bar candle patterns of a row, from it and the rows before it (see
+ * stock_price_patterns()). hh/hl is a higher high/low than the day before,
+ * 2 and 3 are runs of as many days.
+ */
+#define CANDLE_P_INSIDE		(1<<0) /* high and low within the day before's */
+#define CANDLE_P_BULL_ENGULF	(1<<1) /* green, its body covers the red body of the day before */
+#define CANDLE_P_BEAR_ENGULF	(1<<2) /* red, its body covers the green body of the day before */
+#define CANDLE_P_HH		(1<<3)
+#define CANDLE_P_HH2		(1<<4)
+#define CANDLE_P_HH3		(1<<5)
+#define CANDLE_P_HL		(1<<6)
+#define CANDLE_P_HL2		(1<<7)
+#define CANDLE_P_HL3		(1<<8)
+#define CANDLE_P_CLOSE_OVER_HIGH (1<<9) /* close above the high of the day before */
+#define CANDLE_P_RED_AFTER_GREEN (1<<10)
+#define CANDLE_P_HIGH_3D	(1<<11) /* high not below the highs of the 3 days before */
+#define CANDLE_P_LOW_OVER_3D	(1<<12) /* low not below the highs of the 3 days before */
+
+/* dates are kept as the integer yyyymmdd, so they compare as integers */
+#define DATE_FMT	"%04u-%02u-%02u"
+#define DATE_ARG(date)	(date) / 10000, (date) / 100 % 100, (date) % 100
+
+/*
+ * a row is split in two: the fields the checks scan over whole windows
+ * (52 weeks, 40 days, ...) stay in struct date_price, the ones only used
+ * while calculating statistics or by a few checks on a single row live in
+ * struct date_price_cold, kept in a parallel array (stock_price.cold[]).
+ */
 struct date_price
 {
-#define STOCK_DATE_SZ 12
-	char      date[STOCK_DATE_SZ];
-	uint8_t   wday;
+	uint32_t  date; /* yyyymmdd */
 	uint32_t  open, high, low, close;
 	uint32_t  volume;
 	uint32_t  sma[SMA_NR];
 	uint32_t  vma[VMA_NR];
-	uint32_t  typical_price, mfi; /* money flow index */
-	uint64_t  raw_mf;
+	uint32_t  mfi; /* money flow index */
 	uint8_t   candle_color;
 	uint8_t   candle_trend;
 	uint16_t  sr_flag; /* support/resist flag: SR_F_xxx */
+};
+
+struct date_price_cold
+{
+	uint64_t  raw_mf;
+	uint32_t  typical_price;
 	uint32_t  height_low_spt, height_2ndlow_spt, height_high_rst, height_2ndhigh_rst;
+	uint8_t   wday;
+};
+
+/*
+ * rolling state at a row: what each indicator (see indicator.h) keeps of
+ * its window ending there, e.g. the close sum of an sma (of all rows up to
+ * the oldest one if there are fewer). a bar one day newer is added to it
+ * in constant time, so stock_price_append() and a realtime bar don't go
+ * over the history again. it's kept with the rows by the price files and
+ * the database.
+ */
+#define PRICE_STATE_NR	(SMA_NR + VMA_NR + 2) /* state_nr of all indicators */
+
+struct price_state
+{
+	uint32_t date; /* of the row it's at, 0 if not built */
+	uint32_t row_nr; /* rows from there to the oldest one */
+	uint64_t value[PRICE_STATE_NR]; /* of each indicator in turn */
+};
+
+/*
+ * running sums of the rows from the oldest one: sum[i] covers rows
+ * i .. row_nr-1 and sum[row_nr] is 0, so the sum over any window is the
+ * difference of two. a row's raw money flow (typical price * volume) goes
+ * to positive_mf if its typical price is not below the day before, to
+ * negative_mf otherwise. the money flow sums may wrap around, differences
+ * of them are still exact.
+ */
+struct price_sums
+{
+	int row_nr; /* 0 if not built */
+	uint64_t *close, *volume, *positive_mf, *negative_mf;
+};
+
+/*
+ * sparse tables of the row extremes: table[k * row_nr + i] is the extreme
+ * of the 2^k rows from row i, a window's is that of the two power of 2
+ * windows covering it. high and 2ndhigh keep the maximum, low, 2ndlow and
+ * volume the minimum.
+ */
+enum
+{
+	PRICE_RANGE_HIGH,
+	PRICE_RANGE_2ndHIGH,
+	PRICE_RANGE_LOW,
+	PRICE_RANGE_2ndLOW,
+	PRICE_RANGE_VOLUME,
+
+	PRICE_RANGE_NR
+};
+
+struct price_ranges
+{
+	int row_nr; /* 0 if not built */
+	int level_nr;
+	uint32_t *table[PRICE_RANGE_NR];
+};
+
+/*
+ * support/resistance levels sorted by price (then row): one for each of
+ * SR_F_SUPPORT_LOW/2ndLOW and SR_F_RESIST_HIGH/2ndHIGH set on a row, at
+ * the row's low, 2ndlow, high or 2ndhigh, with its height_xxx.
+ */
+struct price_level
+{
+	uint32_t price;
+	uint32_t height;
+	int row;
+	uint16_t sr_flag; /* one SR_F_xxx */
+};
+
+struct price_levels
+{
+	int row_nr; /* 0 if not built */
+	int level_nr;
+	struct price_level *level;
+};
+
+struct price_patterns
+{
+	int row_nr; /* 0 if not built */
+	uint16_t *bits; /* CANDLE_P_xxx of each row */
 };
 
 struct stock_price
 {
 	char sector[48];
 
-#define DATE_PRICE_SZ_MAX   1024
 	int date_cnt;
-	struct date_price dateprice[DATE_PRICE_SZ_MAX];
+	int date_max; /* rows dateprice can hold, if it is malloc'd */
+	struct date_price *dateprice;
+	struct date_price_cold *cold; /* cold[i] goes with dateprice[i] */
+	struct price_state state; /* at the latest row if state.date is dateprice[0].date */
+
+	/* dateprice and cold are read-only: an owned mapping of a price file if map_addr
+	 * is set, borrowed from a price pack otherwise */
+	int readonly;
+	void *map_addr;
+	size_t map_len;
+
+	/* see stock_price_sums(), stock_price_ranges(), stock_price_levels() and
+	 * stock_price_patterns(), dropped when rows are reserved or freed */
+	struct price_sums sums;
+	struct price_ranges ranges;
+	struct price_levels levels;
+	struct price_patterns patterns;
+};
+
+/* the cold half of row, which points into price->dateprice[] */
+static inline struct date_price_cold *date_price_cold(const struct stock_price *price, const struct date_price *row)
+{
+	return &price->cold[row - price->dateprice];
+}
+
+/*
+ * parameters of a scan, the check of a group's symbols by
+ * stock_price_check_screens(). scans share nothing else, so scans with
+ * their own parameters may run at the same time. margins are in 0.1%.
+ */
+struct check_params
+{
+	uint32_t sr_height_margin; /* height of a support/resistance */
+	uint32_t spt_pullback_margin; /* pullback to a support */
+	uint32_t bo_sr_height_margin; /* rise to a breakout */
+	int jobs; /* worker threads */
+};
+
+#define CHECK_PARAMS_INIT \
+	{ .sr_height_margin = 80, .spt_pullback_margin = 55, .bo_sr_height_margin = 50, .jobs = 1 }
+
+/* screens run at once by stock_price_check_screens() */
+#define CHECK_SCREEN_MAX	16
+
+/* groups checked at once by stock_price_check_groups(), see -group=all */
+#define CHECK_GROUP_MAX		16
+
+struct check_group
+{
+	char name[16];
+	int storage; /* PRICE_STORAGE_xxx of the group */
+	struct check_params params;
+	int screen_nr;
+	int screens[CHECK_SCREEN_MAX];
+
+	/* kept in memory by 'anna serve', checked instead of the storage's if histories is set */
+	int history_nr;
+	char **history_symbols;
+	struct stock_price **histories;
+};
+
+struct price_db;
+
+/*
+ * where a group's prices are kept: its price files, or its database if db
+ * is set (storage=sqlite). a pack is built from the price files.
+ */
+struct price_store
+{
+	const char *group;
+	struct price_db *db;
 };
 
+int stock_date_from_str(const char *str, uint32_t *date);
+int stock_price_reserve(struct stock_price *price, int date_cnt);
+void stock_price_free(struct stock_price *price);
+int stock_price_sums(struct stock_price *price);
+uint32_t stock_price_sma(const struct stock_price *price, int idx, int days);
+uint32_t stock_price_vma(const struct stock_price *price, int idx, int days);
+uint32_t stock_price_mfi(const struct stock_price *price, int idx, int days);
+int stock_price_ranges(struct stock_price *price);
+uint32_t stock_price_range(const struct stock_price *price, int range, int idx, int nr);
+int stock_price_date_before(const struct stock_price *price, uint32_t date);
+int stock_price_levels(struct stock_price *price);
+int stock_price_level_find(const struct stock_price *price, uint32_t level_price);
+int stock_price_patterns(struct stock_price *price);
 int stock_price_realtime_from_file(const char *output_fname, struct date_price *price);
 int stock_price_from_file(const char *fname, struct stock_price *price);
-int stock_price_to_file(const char *group, const char *sector, const char *symbol, const struct stock_price *price);
-void fprintf_date_price(FILE *fp, const struct date_price *p);
-void stock_price_check_support(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_sma(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_weeks_low_sma(const char *group, const char *date, int weeks, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_sma_pullback(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_sma_breakout(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_sma_trendup(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_strong_sma_up(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_sma_up(const char *group, const char *date, int sma_idx, int symbols_nr, const char **symbols);
-void stock_price_check_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_mfi_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_pullback_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_52w_doublebottom(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_52w_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_pullback_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_strong_doublebottom_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_pullback(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_strong_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_strong_body_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_resist_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_2nd_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_trend_breakout(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_strong_uptrend(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_52w_low_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_change(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_mfi(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_reverse_up(const char *group, const char *date, int symbols_nr, const char **symbols);
-void stock_price_check_higher_low(const char *group, const char *date, int symbols_nr, const char **symbols);
+int stock_price_history_from_file(const char *fname, struct stock_price *price);
+int stock_price_map_file(const char *fname, struct stock_price *price);
+int stock_price_load(const struct price_store *store, const char *symbol, struct stock_price *price);
+int stock_price_open(const struct price_store *store, const char *symbol, struct stock_price *price);
+int stock_price_append(struct stock_price *price, const struct stock_price *bars);
+int stock_price_state_valid(const struct stock_price *price);
+int stock_price_next_bar(const struct stock_price *price, struct date_price *bar);
+int stock_price_stored(const struct price_store *store, const char *symbol);
+int stock_price_to_file(const struct price_store *store, const char *sector, const char *symbol, const struct stock_price *price);
+int stock_price_rows_to_file(const struct price_store *store, const char *sector, const char *symbol,
+			     const struct stock_price *price, int row_nr);
+void stock_price_dump(const struct price_store *store, int symbols_nr, const char **symbols);
+void fprintf_date_price(FILE *fp, const struct date_price *p, const struct date_price_cold *cold);
+int stock_price_screen_find(const char *name);
+void stock_price_check_screens(const struct check_group *group, const char *date, int symbols_nr, const char **symbols);
+void stock_price_check_groups(const char *date, int jobs, int group_nr, const struct check_group *groups,
+			      int symbols_nr, const char **symbols);
 
 #endif /* __STOCK_PRICE_H__ */
@@ -1,10 +1,10 @@
 #include "util.h"
 
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
-uint32_t sr_height_margin = 80; /* support/resist height: 8% */
-uint32_t spt_pullback_margin = 55; /* 7.5% pullback */
-uint32_t bo_sr_height_margin = 50;
+int history_years = 1;
 int fetch_source = FETCH_SOURCE_YAHOO;
 
 void strlcpy(char *dest, const char *src, int dest_sz)
@@ -12,3 +12,51 @@ void strlcpy(char *dest, const char *src, int dest_sz)
 	strncpy(dest, src, dest_sz - 1);
 	dest[dest_sz - 1] = 0;
 }
+
+int read_full(int fd, void *buf, size_t sz)
+{
+	size_t done = 0;
+
+	while (done < sz) {
+		ssize_t n = read(fd, (char *)buf + done, sz - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		done += n;
+	}
+
+	return 0;
+}
+
+int write_full(int fd, const void *buf, size_t sz)
+{
+	size_t done = 0;
+
+	while (done < sz) {
+		ssize_t n = write(fd, (const char *)buf + done, sz - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		done += n;
+	}
+
+	return 0;
+}
+
+int pwrite_full(int fd, const void *buf, size_t sz, off_t offset)
+{
+	size_t done = 0;
+
+	while (done < sz) {
+		ssize_t n = pwrite(fd, (const char *)buf + done, sz - done, offset + done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		done += n;
+	}
+
+	return 0;
+}
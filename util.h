@@ -2,6 +2,8 @@
 #define __UTIL_H__
 
 #include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
 
 #define anna_error(fmt, args...) \
 	fprintf(stderr, "[%s:%s:%d] " fmt, __FILE__, __FUNCTION__, __LINE__, ##args)
@@ -21,6 +23,9 @@
 	} while (0)
 
 void strlcpy(char *dest, const char *src, int dest_sz);
+int read_full(int fd, void *buf, size_t sz);
+int write_full(int fd, const void *buf, size_t sz);
+int pwrite_full(int fd, const void *buf, size_t sz, off_t offset);
 
 #define ROOT_DIR      "/dev/shm/anna"
 #define ROOT_DIR_TMP  ROOT_DIR "/tmp"
@@ -33,9 +38,7 @@ void strlcpy(char *dest, const char *src, int dest_sz);
 #define ANSI_COLOR_CYAN    "\x1b[36m"
 #define ANSI_COLOR_RESET   "\x1b[0m"
 
-extern uint32_t sr_height_margin;
-extern uint32_t spt_pullback_margin;
-extern uint32_t bo_sr_height_margin;
+extern int history_years; /* of daily bars fetched per symbol */
 
 enum
 {
@@ -45,4 +48,11 @@ enum
 
 extern int fetch_source;
 
+enum
+{
+	PRICE_STORAGE_FILE, /* ROOT_DIR/<group>/<symbol>.price */
+	PRICE_STORAGE_PACK, /* ROOT_DIR/<group>.pack, built from the price files */
+	PRICE_STORAGE_SQLITE, /* ROOT_DIR/<group>.db */
+};
+
 #endif /* __UTIL_H__ */